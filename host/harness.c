@@ -0,0 +1,255 @@
+/* Erich Woo & Boxian Wang
+ * 6 December 2020
+ * Host-native unit tests and microbenchmarks for the kernel data structures:
+ * linked lists (linked_list.c), circular buffers (buffer.c), and the
+ * physical frame bitmap (memory.c)
+ *
+ * usage: harness test       run the unit tests, exit status 1 on any failure
+ *        harness bench      run the microbenchmarks
+ *
+ * Benchmark results are printed one per line as
+ *   HOSTBENCH <name> <param>=<value> ops=<n> ns_per_op=<x>
+ */
+
+#include "ykernel.h"
+#include "linked_list.h"
+#include "buffer.h"
+#include "memory.h"
+#include "host.h"
+
+// the kernel globals memory.c relies on, normally defined in kernel.c
+free_frame_t free_frame;
+kernel_global_pt_t kernel_pt;
+
+int failures = 0;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { host_printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); failures++; } \
+  } while (0)
+
+/* Sets up free_frame as KernelStart does, with n physical frames */
+void frames_init(int n) {
+  kfree(free_frame.bit_vector);
+  kfree(free_frame.info);
+  free_frame.size = n;
+  free_frame.avail_pfn = BASE_FRAME;
+  free_frame.filled = 0;
+  free_frame.failures = 0;
+  free_frame.bit_vector = kcalloc(n / CELL_SIZE + 1, sizeof(char), KH_FRAMES);
+  free_frame.info = kcalloc(n, sizeof(frame_info_t), KH_FRAMES);
+}
+
+/* Reports one microbenchmark result */
+void report(char *name, char *param, int value, int ops, long long ns) {
+  host_printf("HOSTBENCH %s %s=%d ops=%d ns_per_op=%.1f\n", name, param, value, ops, (double) ns / ops);
+}
+
+/////////////// unit tests
+
+void test_ll(void) {
+  ll_t *list = new_ll();
+  node_t *n[4];
+  CHECK(is_empty(list) == 1 && get_size(list) == 0);
+  CHECK(dequeue(list) == NULL && pop(list) == NULL);
+  for (int i = 0; i < 4; i++) {
+    n[i] = new_node(NULL);
+    n[i]->code = i;
+    enqueue(list, n[i]);
+  }
+  CHECK(get_size(list) == 4 && list->head == n[0] && list->tail == n[3]);
+  CHECK(find(list, 2) == n[2] && find(list, 7) == NULL);
+  n[2]->data = list;
+  CHECK(find_data(list, list) == n[2] && find_data(list, n) == NULL && find_data(NULL, list) == NULL);
+  n[2]->data = NULL;
+  CHECK(has_member(list, n[1]) && !has_member(list, NULL));
+
+  CHECK(remove(list, n[1]) == n[1]); // middle
+  CHECK(get_size(list) == 3 && n[0]->next == n[2] && n[2]->prev == n[0] && !has_member(list, n[1]));
+  CHECK(remove(list, n[3]) == n[3]); // tail
+  CHECK(list->tail == n[2] && n[2]->next == NULL);
+  CHECK(remove(list, n[0]) == n[0]); // head
+  CHECK(list->head == n[2] && n[2]->prev == NULL && get_size(list) == 1);
+
+  push(list, n[0]);
+  enqueue(list, n[3]);
+  CHECK(dequeue(list) == n[0] && pop(list) == n[3] && dequeue(list) == n[2]);
+  CHECK(is_empty(list) && list->head == NULL && list->tail == NULL);
+  CHECK(get_size(NULL) == -1 && is_empty(NULL) == -1);
+
+  ll_t *other = new_ll();
+  splice(list, other); // empty into empty
+  CHECK(is_empty(list) && list->head == NULL);
+  enqueue(other, n[0]);
+  enqueue(other, n[1]);
+  splice(list, other); // into empty
+  CHECK(get_size(list) == 2 && list->head == n[0] && list->tail == n[1]);
+  CHECK(is_empty(other) && other->head == NULL && other->tail == NULL);
+  enqueue(other, n[2]);
+  enqueue(other, n[3]);
+  splice(list, other); // onto the tail
+  CHECK(get_size(list) == 4 && list->tail == n[3] && n[1]->next == n[2] && n[2]->prev == n[1]);
+  CHECK(is_empty(other));
+  splice(list, other); // empty onto non-empty
+  splice(NULL, list);
+  CHECK(get_size(list) == 4 && list->tail == n[3]);
+  for (int i = 0; i < 4; i++) CHECK(dequeue(list) == n[i]);
+  kfree(other);
+
+  for (int i = 0; i < 4; i++) destroy_node(n[i]);
+  kfree(list);
+}
+
+void test_buffer(void) {
+  buffer_t *b = new_buffer(8, 8);
+  char out[16];
+  CHECK(read_buffer(b, out, 4) == 0);
+  CHECK(write_buffer(b, "abcdef", 6) == 6 && b->filled == 6);
+  CHECK(read_buffer(b, out, 4) == 4 && memcmp(out, "abcd", 4) == 0);
+  CHECK(write_buffer(b, "ghijklmn", 8) == 6); // only 6 fit, and wrap around
+  CHECK(b->filled == 8);
+  CHECK(read_buffer(b, out, 16) == 8 && memcmp(out, "efghijkl", 8) == 0);
+  CHECK(b->filled == 0);
+  CHECK(write_buffer(b, "xyz", 3) == 3);
+  reset_buffer(b);
+  CHECK(b->filled == 0 && read_buffer(b, out, 3) == 0);
+  destroy_buffer(b);
+
+  b = new_buffer(3, 20); // rounds up to 4, grows on demand up to 20
+  CHECK(b->size == 4 && b->cap == 20);
+  CHECK(write_buffer(b, "abc", 3) == 3 && read_buffer(b, out, 2) == 2); // head now off the front
+  CHECK(write_buffer(b, "defgh", 5) == 5 && b->size == 8); // grows, unwrapping "c" to the front
+  CHECK(b->head == 0 && read_buffer(b, out, 16) == 6 && memcmp(out, "cdefgh", 6) == 0);
+  CHECK(write_buffer(b, "0123456789abcdefghijklmn", 24) == 20 && b->size == 32);
+  CHECK(set_buffer_cap(b, 10) == ERROR && set_buffer_cap(b, 24) == 0);
+  CHECK(write_buffer(b, "xyzw", 4) == 4 && write_buffer(b, "!", 1) == 0);
+  CHECK(read_buffer(b, out, 24) == 24 && memcmp(out, "0123456789abcdefghijxyzw", 24) == 0);
+  CHECK(set_buffer_cap(b, 5) == 0 && write_buffer(b, "1234567", 7) == 5); // shrinking caps the fill only
+  destroy_buffer(b);
+}
+
+void test_frames(void) {
+  frames_init(64);
+  CHECK(frames_left() == 64);
+  CHECK(get_frame(NONE, AUTO, 3, FRAME_UHEAP) == BASE_FRAME);
+  CHECK(get_frame(NONE, AUTO, 3, FRAME_USTACK) == BASE_FRAME + 1);
+  CHECK(get_frame(BASE_FRAME + 5, FIXED, KERNEL_OWNER, FRAME_KTEXT) == BASE_FRAME + 5);
+  CHECK(frames_left() == 61);
+  CHECK(free_frame.info[1].pid == 3 && free_frame.info[1].purpose == FRAME_USTACK);
+
+  vacate_frame(BASE_FRAME);
+  CHECK(free_frame.info[0].purpose == FRAME_FREE);
+  CHECK(get_frame(NONE, AUTO, 4, FRAME_UTEXT) == BASE_FRAME); // lowest free is reused
+
+  CHECK(share_frame(BASE_FRAME + 1) == BASE_FRAME + 1); // e.g. flipped into a pipe
+  CHECK(free_frame.info[1].refs == 2 && free_frame.info[1].cow == 1);
+  vacate_frame(BASE_FRAME + 1); // one holder lets go, the frame stays
+  CHECK(free_frame.info[1].refs == 1 && free_frame.info[1].purpose == FRAME_USTACK && frames_left() == 61);
+
+  mem_info_t info;
+  mem_info(&info);
+  CHECK(info.total_frames == 64 && info.free_frames == 61);
+  CHECK(info.largest_free_run == 64 - 6);
+  CHECK(info.frames[FRAME_UTEXT] == 1 && info.frames[FRAME_KTEXT] == 1);
+  CHECK(info.num_owners == 3);
+
+  frames_init(64);
+  for (int pid = 0; pid < MEMINFO_MAX_OWNERS + 5; pid++) get_frame(NONE, AUTO, pid, FRAME_UHEAP);
+  get_frame(NONE, AUTO, MEMINFO_MAX_OWNERS + 2, FRAME_USTACK); // a second frame of an owner without a slot
+  mem_info(&info);
+  CHECK(info.num_owners == MEMINFO_MAX_OWNERS + 5); // counted exactly past the table
+  CHECK(info.owners[MEMINFO_MAX_OWNERS - 1].pid == MEMINFO_MAX_OWNERS - 1);
+  CHECK(info.frames[FRAME_UHEAP] == MEMINFO_MAX_OWNERS + 5 && info.frames[FRAME_USTACK] == 1);
+
+  while (frames_left() > 0) get_frame(NONE, AUTO, 5, FRAME_UHEAP);
+  CHECK(get_frame(NONE, AUTO, 5, FRAME_UHEAP) == ERROR);
+  CHECK(!enough_frames(1));
+  CHECK(free_frame.failures == 2);
+}
+
+/////////////// microbenchmarks
+
+void bench_ll(int n) {
+  ll_t *list = new_ll();
+  node_t **nodes = malloc(n * sizeof(node_t *));
+  int lookups = n < 2000 ? n : 2000;
+  long long start = host_now_ns();
+  for (int i = 0; i < n; i++) {
+    nodes[i] = new_node(NULL);
+    nodes[i]->code = i;
+    enqueue(list, nodes[i]);
+  }
+  report("ll_enqueue", "n", n, n, host_now_ns() - start);
+
+  start = host_now_ns();
+  for (int i = 0; i < lookups; i++) find(list, host_rand(n));
+  report("ll_find", "n", n, lookups, host_now_ns() - start);
+
+  start = host_now_ns();
+  for (int i = 0; i < lookups; i++) has_member(list, nodes[host_rand(n)]);
+  report("ll_has_member", "n", n, lookups, host_now_ns() - start);
+
+  start = host_now_ns();
+  for (int i = 0; i < n; i += 2) remove(list, nodes[i]);
+  report("ll_remove", "n", n, (n + 1) / 2, host_now_ns() - start);
+
+  start = host_now_ns();
+  int left = get_size(list);
+  while (!is_empty(list)) dequeue(list);
+  report("ll_dequeue", "n", n, left, host_now_ns() - start);
+
+  for (int i = 0; i < n; i++) destroy_node(nodes[i]);
+  free(nodes);
+  kfree(list);
+}
+
+void bench_buffer(int size, int chunk, int total) {
+  buffer_t *b = new_buffer(size, size);
+  char *data = calloc(chunk, 1);
+  long long start = host_now_ns();
+  for (int moved = 0; moved < total; ) {
+    write_buffer(b, data, chunk);
+    moved += read_buffer(b, data, chunk);
+  }
+  report("buffer_rw", "chunk", chunk, total / chunk, host_now_ns() - start);
+  free(data);
+  destroy_buffer(b);
+}
+
+void bench_frames(int n) {
+  frames_init(n);
+  for (int i = 0; i < n; i++) get_frame(NONE, AUTO, 1, FRAME_UHEAP);
+  for (int i = 0; i < n; i++) // fragment: free a random half
+    if (host_rand(2)) vacate_frame(BASE_FRAME + i);
+
+  int ops = n * 4;
+  long long start = host_now_ns();
+  for (int i = 0; i < ops; i++) { // random churn at constant occupancy
+    int pfn = get_frame(NONE, AUTO, 1, FRAME_UHEAP);
+    int victim = BASE_FRAME + host_rand(n);
+    if (free_frame.info[victim - BASE_FRAME].purpose != FRAME_FREE) vacate_frame(victim);
+    else vacate_frame(pfn);
+  }
+  report("frame_churn", "frames", n, ops, host_now_ns() - start);
+
+  start = host_now_ns();
+  mem_info_t info;
+  mem_info(&info);
+  report("mem_info", "frames", n, 1, host_now_ns() - start);
+}
+
+int main(int argc, char *argv[]) {
+  host_srand(58);
+  if (argc > 1 && strcmp(argv[1], "bench") == 0) {
+    for (int n = 1000; n <= 100000; n *= 10) bench_ll(n);
+    for (int chunk = 1; chunk <= 4096; chunk *= 8) bench_buffer(4096, chunk, 1 << 24);
+    bench_buffer(PIPE_BUFFER_LEN, PIPE_BUFFER_LEN, 1 << 24);
+    for (int n = 1024; n <= 65536; n *= 8) bench_frames(n);
+    return 0;
+  }
+
+  test_ll();
+  test_buffer();
+  test_frames();
+  host_printf("%s: %d failure(s)\n", failures ? "FAILED" : "PASSED", failures);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,24 @@
+/* Erich Woo & Boxian Wang
+ * 6 December 2020
+ * header file for stubs.c: host-side helpers for the harness
+ *
+ * The harness can't include <stdio.h> next to linked_list.h (remove() clashes),
+ * so printing, timing and randomness go through these.
+ */
+
+#ifndef __HOST_H
+#define __HOST_H
+
+/* printf to stdout */
+void host_printf(const char *fmt, ...);
+
+/* @return a monotonic timestamp in nanoseconds */
+long long host_now_ns(void);
+
+/* Seeds host_rand */
+void host_srand(unsigned int seed);
+
+/* @return a pseudo-random int in [0, n) */
+int host_rand(int n);
+
+#endif // __HOST_H
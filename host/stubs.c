@@ -0,0 +1,70 @@
+/* Erich Woo & Boxian Wang
+ * 6 December 2020
+ * Host-native stand-ins for the Yalnix hardware and helper functions,
+ * and the host helpers in host.h
+ */
+
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <stdarg.h>
+#include <time.h>
+#include "ykernel.h"
+#include "host.h"
+
+void *_kernel_data_start, *_kernel_data_end, *_kernel_orig_brk;
+
+int trace_level = 0; // TracePrintf levels above this are dropped
+
+int TracePrintf(int level, char *fmt, ...) {
+  if (level > trace_level) return 0;
+  va_list ap;
+  va_start(ap, fmt);
+  vfprintf(stderr, fmt, ap);
+  va_end(ap);
+  return 0;
+}
+
+void WriteRegister(int reg, unsigned int value) {}
+
+unsigned int ReadRegister(int reg) {
+  return 0; // VM is never "enabled" on the host
+}
+
+void Halt(void) {
+  exit(1);
+}
+
+int next_pid = 0;
+
+int helper_new_pid(pte_t *pt) {
+  return next_pid++;
+}
+
+void helper_retire_pid(int pid) {}
+
+void host_printf(const char *fmt, ...) {
+  va_list ap;
+  va_start(ap, fmt);
+  vprintf(fmt, ap);
+  va_end(ap);
+  fflush(stdout);
+}
+
+long long host_now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (long long) ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+unsigned int rand_state = 1;
+
+void host_srand(unsigned int seed) {
+  rand_state = seed ? seed : 1;
+}
+
+int host_rand(int n) { // xorshift32
+  rand_state ^= rand_state << 13;
+  rand_state ^= rand_state >> 17;
+  rand_state ^= rand_state << 5;
+  return rand_state % n;
+}
@@ -0,0 +1,89 @@
+/* Erich Woo & Boxian Wang
+ * 6 December 2020
+ * Host-native stand-in for the Yalnix ykernel.h
+ *
+ * Just enough of the hardware interface (constants, pte_t, contexts, and
+ * the hardware/helper functions, implemented in stubs.c) for the kernel data
+ * structure modules to compile and run natively. Only used by the host build.
+ */
+
+#ifndef __HOST_YKERNEL_H
+#define __HOST_YKERNEL_H
+
+#include <stdlib.h>
+#include <string.h>
+
+// NOTE: no <stdio.h> here, it would clash with remove() in linked_list.h
+
+#define PAGESHIFT 13
+#define PAGESIZE (1 << PAGESHIFT)
+#define PAGEOFFSET (PAGESIZE - 1)
+#define PAGEMASK (~PAGEOFFSET)
+#define UP_TO_PAGE(n) (((long) (n) + PAGEOFFSET) & PAGEMASK)
+#define DOWN_TO_PAGE(n) ((long) (n) & PAGEMASK)
+
+#define VMEM_REGION_SIZE 0x100000
+#define VMEM_0_BASE 0
+#define VMEM_0_SIZE VMEM_REGION_SIZE
+#define VMEM_0_LIMIT (VMEM_0_BASE + VMEM_0_SIZE)
+#define VMEM_1_BASE VMEM_0_LIMIT
+#define VMEM_1_SIZE VMEM_REGION_SIZE
+#define VMEM_1_LIMIT (VMEM_1_BASE + VMEM_1_SIZE)
+#define MAX_PT_LEN (VMEM_REGION_SIZE >> PAGESHIFT)
+#define PMEM_BASE 0
+
+#define KERNEL_STACK_MAXSIZE (2 * PAGESIZE)
+#define KERNEL_STACK_BASE (VMEM_0_LIMIT - KERNEL_STACK_MAXSIZE)
+#define KERNEL_STACK_LIMIT VMEM_0_LIMIT
+
+#define NUM_TERMINALS 4
+#define TERMINAL_MAX_LINE 1024
+#define PIPE_BUFFER_LEN 256
+
+#define PROT_NONE 0
+#define PROT_READ 1
+#define PROT_WRITE 2
+#define PROT_EXEC 4
+#define PROT_ALL (PROT_READ | PROT_WRITE | PROT_EXEC)
+
+#define ERROR (-1)
+#define SUCCESS 0
+#define KILL (-2)
+
+#define REG_VM_ENABLE 5
+#define REG_TLB_FLUSH 6
+#define REG_PTBR1 3
+#define TLB_FLUSH_1 (-3)
+#define TLB_FLUSH_KSTACK (-4)
+
+typedef struct pte {
+  unsigned int valid : 1;
+  unsigned int prot : 3;
+  unsigned int unused : 4;
+  unsigned int pfn : 24;
+} pte_t;
+
+typedef struct UserContext {
+  int vector;
+  int code;
+  void *addr;
+  void *pc;
+  void *sp;
+  void *ebp;
+  unsigned long regs[8];
+} UserContext;
+
+typedef struct KernelContext {
+  char state[256];
+} KernelContext;
+
+extern void *_kernel_data_start, *_kernel_data_end, *_kernel_orig_brk;
+
+int TracePrintf(int level, char *fmt, ...);
+void WriteRegister(int reg, unsigned int value);
+unsigned int ReadRegister(int reg);
+void Halt(void);
+int helper_new_pid(pte_t *pt);
+void helper_retire_pid(int pid);
+
+#endif // __HOST_YKERNEL_H
@@ -0,0 +1,83 @@
+/* Erich Woo & Boxian Wang
+ * 6 December 2020
+ * Circular buffer manipulation. See buffer.h for detailed documentation
+ */
+
+#include "buffer.h"
+
+// rounds n up to the next power of 2
+int pow2_ceil(int n) {
+  int p = 1;
+  while (p < n) p <<= 1;
+  return p;
+}
+
+buffer_t *new_buffer(int size, int cap) {
+  buffer_t *new = kmalloc(sizeof(buffer_t), KH_BUFFER);
+  new->size = pow2_ceil(size);
+  new->buffered = kcalloc(new->size, sizeof(char), KH_BUFFER);
+  new->cap = cap;
+  new->filled = new->head = new->tail = 0;
+  return new;
+}
+
+int grow_buffer(buffer_t *buffer, int need) {
+  int size = pow2_ceil(need < buffer->cap ? need : buffer->cap);
+  if (size <= buffer->size) return 0;
+  char *grown = kmalloc(size, KH_BUFFER);
+  if (grown == NULL) return 0; // make do with what we have
+  int filled = read_buffer(buffer, grown, buffer->filled); // unwraps the contents to the front
+  kfree(buffer->buffered);
+  buffer->buffered = grown;
+  buffer->size = size;
+  buffer->filled = buffer->tail = filled;
+  buffer->head = 0;
+  return 1;
+}
+
+int set_buffer_cap(buffer_t *buffer, int cap) {
+  if (cap < buffer->filled) return ERROR;
+  buffer->cap = cap;
+  return 0;
+}
+
+int write_buffer(buffer_t *buffer, char *src, int len) {
+  if (buffer->filled + len > buffer->size && buffer->size < buffer->cap)
+    grow_buffer(buffer, buffer->filled + len);
+  int limit = buffer->size < buffer->cap ? buffer->size : buffer->cap;
+  int avail = limit - buffer->filled;
+  int written = avail < len ? avail : len;
+  if (written <= 0) return 0;
+  int first = buffer->size - buffer->tail; // room before wrapping around
+  if (first > written) first = written;
+  memcpy(buffer->buffered + buffer->tail, src, first);
+  memcpy(buffer->buffered, src + first, written - first);
+  buffer->tail = (buffer->tail + written) & (buffer->size - 1);
+  buffer->filled += written;
+  return written;
+} 
+
+int read_buffer(buffer_t *buffer, char *dst, int len) {
+  int read = buffer->filled < len ? buffer->filled : len;
+  if (read <= 0) return 0;
+  int first = buffer->size - buffer->head; // bytes before wrapping around
+  if (first > read) first = read;
+  memcpy(dst, buffer->buffered + buffer->head, first);
+  memcpy(dst + first, buffer->buffered, read - first);
+  buffer->head = (buffer->head + read) & (buffer->size - 1);
+  buffer->filled -= read;
+  return read;
+} 
+
+void reset_buffer(buffer_t *buffer) {
+  buffer->filled = buffer->head = buffer->tail = 0;
+}
+
+void destroy_buffer(buffer_t *buffer) {
+  buffer->size = 0;      // safety
+  reset_buffer(buffer);
+  kfree(buffer->buffered);
+  buffer->buffered = NULL;
+  kfree(buffer);
+  buffer = NULL;
+}
@@ -0,0 +1,85 @@
+/* Erich Woo & Boxian Wang
+ * 6 December 2020
+ * header file for buffer.c
+ */
+
+#ifndef __BUFFER_H
+#define __BUFFER_H
+
+#include "ykernel.h"
+#include "kheap.h"
+
+// circular buffer
+typedef struct buffer {
+  int size;   // allocated size, always a power of 2
+  int cap;    // max bytes it may hold; grows the allocation on demand up to this
+  int filled;
+  int head; // first char index
+  int tail; // one after the last char index (everything mod size, i.e. & (size - 1))
+  char *buffered;
+} buffer_t;
+
+/******************************* FUNCTION DECLARATIONS *****************************/
+
+/* Initializes and returns a new buffer pointer
+ * Must be free'd later by caller
+ *
+ * @param size the initial size of the new buffer, rounded up to a power of 2
+ * @param cap the max # of bytes the buffer may ever hold
+ * @return the initialized buffer pointer
+ */
+buffer_t *new_buffer(int size, int cap);
+
+/* Grows the buffer's allocation to fit at least need bytes (but not past its cap),
+ * keeping its contents
+ *
+ * @param buffer the buffer to grow
+ * @param need the # of bytes the buffer should fit
+ * @return 1 if grown, 0 if already big enough, at cap, or out of kernel heap
+ */
+int grow_buffer(buffer_t *buffer, int need);
+
+/* Sets the max # of bytes the buffer may hold. The allocation is
+ * left alone; it grows later on demand
+ *
+ * @param buffer the buffer to set the cap of
+ * @param cap the new cap
+ * @return 0 on success, ERROR if the buffer already holds more than cap
+ */
+int set_buffer_cap(buffer_t *buffer, int cap);
+
+/* Writes len bytes of the src string to the buffer, as at most two
+ * contiguous copies. Grows the buffer first if it's too small and below cap.
+ * If the avalailable space remaining in the buffer is less than len, 
+ * only the available amount is written.
+ *
+ * @param buffer the buffer pointer to write to
+ * @param src the source sring to write into buffer
+ * @param len the number of bytes to write
+ * @return the number of bytes ACTUALLy written
+ */
+int write_buffer(buffer_t *buffer, char *src, int len);
+
+/* Reads up to len bytes from the buffer into dst, as at most two contiguous copies.
+ * If the buffer holds less than len, only what it holds is read.
+ *
+ * @param buffer the buffer pointer to read from
+ * @param dst the char* destination to store the read bytes into
+ * @param len the number of bytes to read
+ * @return the number of bytes ACTUALLY read 
+ */
+int read_buffer(buffer_t *buffer, char *dst, int len);
+
+/* Resets the buffer as if new
+ *
+ * @param buffer the buffer to reset
+ */
+void reset_buffer(buffer_t *buffer);
+
+/* Destroys/frees the buffer and its contents
+ *
+ * @param buffer the buffer to destroy
+ */
+void destroy_buffer(buffer_t *buffer);
+
+#endif //__BUFFER_H
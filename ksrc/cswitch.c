@@ -87,7 +87,7 @@ KernelContext* KCCopy(KernelContext *kc_in, void *new_pcb_p, void *not_used) {
     // copy kernel stack; has to be done in a magical stack!
     int dummy = BASE_PAGE_KSTACK - 1;
     for (int vpn = BASE_PAGE_KSTACK; vpn < LIM_PAGE_KSTACK; vpn++) {
-        set_pte(&kernel_pt.pt[dummy - BASE_PAGE_0], 1, get_frame(NONE, AUTO), PROT_READ|PROT_WRITE);
+        set_pte(&kernel_pt.pt[dummy - BASE_PAGE_0], 1, get_frame(NONE, AUTO, new_pcb->pid, FRAME_KSTACK), PROT_READ|PROT_WRITE);
         WriteRegister(REG_TLB_FLUSH, dummy << PAGESHIFT); // must flush after use!
         memcpy((void*) (dummy << PAGESHIFT), (void*) (vpn << PAGESHIFT), PAGESIZE);
         
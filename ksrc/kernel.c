@@ -15,6 +15,8 @@ kernel_global_pt_t kernel_pt;
 node_t *init_node = NULL, *idle_node = NULL;
 io_control_t *io;
 pilocvar_t *pilocvar;
+int tty_out_ring = TTY_OUT_RING; // set by the ttyq= boot option
+int tty_in_ring = TTY_IN_RING; // set by the ttyin= boot option
 
 /********************** FUNCTION DECLARATIONS ******************/
 
@@ -41,6 +43,16 @@ void idle_setup(UserContext* uctxt);
  */
 void init_load(char *name, char *args[], UserContext *uctxt);
 
+/* Parses the key=value boot options preceding the init program in cmd_args:
+ *   ttyq=<bytes>  size of each terminal's output ring (default TTY_OUT_RING)
+ *   ttyin=<bytes> size of each terminal's input ring (default TTY_IN_RING)
+ * Unknown or out-of-range options are traced and ignored
+ *
+ * @param cmd_args the boot command-line args
+ * @return the index of the first arg that isn't an option, i.e. the init program
+ */
+int boot_options(char *cmd_args[]);
+
 /* Entrance of the OS at boot. 
  * Sets up VM, traps, process/pipe/lock/cvar/io control,
  * and loads as init cloning into idle
@@ -63,11 +75,11 @@ void VM_setup(void) {
   // fill in the pagetable so that vpn = pfn
   for (int vpn = BASE_PAGE_0; vpn < LIM_PAGE_0; vpn++) {
     if (vpn < (unsigned int) _kernel_data_start >> PAGESHIFT) {
-      set_pte(&kernel_pt.pt[vpn - BASE_PAGE_0], 1, get_frame(vpn, FIXED), PROT_READ|PROT_EXEC);
+      set_pte(&kernel_pt.pt[vpn - BASE_PAGE_0], 1, get_frame(vpn, FIXED, KERNEL_OWNER, FRAME_KTEXT), PROT_READ|PROT_EXEC);
     } else if (vpn <= (unsigned int) kernel_pt.brk >> PAGESHIFT) {
-      set_pte(&kernel_pt.pt[vpn - BASE_PAGE_0], 1, get_frame(vpn, FIXED), PROT_READ|PROT_WRITE);
+      set_pte(&kernel_pt.pt[vpn - BASE_PAGE_0], 1, get_frame(vpn, FIXED, KERNEL_OWNER, FRAME_KHEAP), PROT_READ|PROT_WRITE);
     } else if (vpn >= BASE_PAGE_KSTACK) {
-      set_pte(&kernel_pt.pt[vpn - BASE_PAGE_0], 1, get_frame(vpn, FIXED), PROT_READ|PROT_WRITE);
+      set_pte(&kernel_pt.pt[vpn - BASE_PAGE_0], 1, get_frame(vpn, FIXED, KERNEL_OWNER, FRAME_KSTACK), PROT_READ|PROT_WRITE);
     } else {
       set_pte(&kernel_pt.pt[vpn - BASE_PAGE_0], 0, NONE, NONE);
     }
@@ -108,13 +120,43 @@ void idle_setup(UserContext* uctxt) {
   idle_pcb->uc = *uctxt; // cp usercontext
 
   unsigned int usr_stack_vpn = LIM_PAGE_1 - 1;
-  set_pte(&idle_pcb->userpt->pt[usr_stack_vpn - BASE_PAGE_1], 1, get_frame(NONE, AUTO), PROT_READ|PROT_WRITE); // assign one page
+  set_pte(&idle_pcb->userpt->pt[usr_stack_vpn - BASE_PAGE_1], 1, get_frame(NONE, AUTO, idle_pcb->pid, FRAME_USTACK), PROT_READ|PROT_WRITE); // assign one page
 
   idle_pcb->uc.pc = DoIdle; // point to doIdle();
   idle_pcb->uc.sp = (void *)((unsigned int) VMEM_1_LIMIT - 4); // hook up uc stack pointer to top of user stack
   copy_kernel(idle_node);
 }
 
+// returns whether arg looks like a key=value boot option
+int is_boot_option(char *arg) {
+  for (; *arg != '\0'; arg++) if (*arg == '=') return 1;
+  return 0;
+}
+
+// parses arg as key=<decimal> into value, returning 1 if it matches key and is well-formed
+int boot_option(char *arg, char *key, int *value) {
+  for (; *key != '\0'; key++, arg++) if (*arg != *key) return 0;
+  if (*arg++ != '=' || *arg == '\0') return 0;
+  *value = 0;
+  for (char *c = arg; *c != '\0'; c++) {
+    if (*c < '0' || *c > '9' || *value >= 100000000) return 0; // too big for any option
+    *value = *value * 10 + (*c - '0');
+  }
+  return 1;
+}
+
+int boot_options(char *cmd_args[]) {
+  int i, value;
+  for (i = 0; cmd_args[i] != NULL && is_boot_option(cmd_args[i]); i++) {
+    if (boot_option(cmd_args[i], "ttyq", &value) && value >= TERMINAL_MAX_LINE && value <= TTY_RING_MAX)
+      tty_out_ring = value;
+    else if (boot_option(cmd_args[i], "ttyin", &value) && value >= TERMINAL_MAX_LINE && value <= TTY_RING_MAX)
+      tty_in_ring = value;
+    else TracePrintf(0, "Ignoring boot option %s\n", cmd_args[i]);
+  }
+  return i;
+}
+
 void init_load(char *name, char *args[], UserContext *uctxt) {
   init_node = process_init();
   pcb_t *init_pcb = init_node->data;
@@ -123,6 +165,7 @@ void init_load(char *name, char *args[], UserContext *uctxt) {
 
   for (int vpn = BASE_PAGE_KSTACK; vpn < LIM_PAGE_KSTACK; vpn++) { // create copy of kernel stack mapping
     init_pcb->kstack->pt[vpn - BASE_PAGE_KSTACK] = kernel_pt.pt[vpn - BASE_PAGE_0];
+    set_frame_owner(kernel_pt.pt[vpn - BASE_PAGE_0].pfn, init_pcb->pid, FRAME_KSTACK); // boot stack is init's now
   }
 
   WriteRegister(REG_PTBR1, (unsigned int) init_pcb->userpt->pt); // 
@@ -142,21 +185,24 @@ void KernelStart(char *cmd_args[], unsigned int pmem_size, UserContext *uctxt) {
   free_frame.size = pmem_size / PAGESIZE;
   free_frame.avail_pfn = BASE_FRAME;
   free_frame.filled = 0;
-  free_frame.bit_vector = malloc(free_frame.size / CELL_SIZE + 1);
+  free_frame.failures = 0;
+  free_frame.bit_vector = kmalloc(free_frame.size / CELL_SIZE + 1, KH_FRAMES);
   for (int i = 0; i < free_frame.size / CELL_SIZE + 1; i++) free_frame.bit_vector[i] = (char) 0; // initialzied
+  free_frame.info = kcalloc(free_frame.size, sizeof(frame_info_t), KH_FRAMES); // all FRAME_FREE
   
   VM_setup();
   // Traps
   trap_setup();
   // Process control
   procs = proc_table_init();
+  // Boot options
+  int prog = boot_options(cmd_args);
   // Terminal IO
-  io = io_control_init();
+  io = io_control_init(tty_out_ring, tty_in_ring);
   // Pipes, Locks, Cvars
   pilocvar = pilocvar_init();
   
-  //!!! cmdline args checking here
-  init_load(cmd_args[0], cmd_args, uctxt);
+  init_load(cmd_args[prog], cmd_args + prog, uctxt);
 
   idle_setup(uctxt); 
   if (procs->running == init_node) TracePrintf(1, "Leaving KStart\n");
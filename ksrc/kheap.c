@@ -0,0 +1,59 @@
+/* Erich Woo & Boxian Wang
+ * 4 December 2020
+ * Kernel heap profiling by allocation site. See kheap.h for detailed documentation
+ */
+
+#include "kheap.h"
+#include "memory.h"
+
+// THE global kernel page tables, for the kernel brk
+extern kernel_global_pt_t kernel_pt;
+
+#ifdef KHEAP_PROFILE
+
+// the header hidden in front of every profiled allocation
+typedef struct kheap_tag {
+  int site;
+  int size;
+} kheap_tag_t;
+
+// per-site bookkeeping
+kheap_site_t kheap_sites[NUM_KH_SITES];
+
+void *kheap_alloc(int size, int site, int zero) {
+  kheap_tag_t *tag = malloc(sizeof(kheap_tag_t) + size);
+  if (tag == NULL) return NULL;
+  if (zero) memset(tag + 1, 0, size);
+  if (site < 0 || site >= NUM_KH_SITES) site = KH_OTHER;
+  tag->site = site;
+  tag->size = size;
+
+  kheap_site_t *s = &kheap_sites[site];
+  s->allocs++;
+  s->live_objects++;
+  s->live_bytes += size;
+  if (s->live_bytes > s->peak_bytes) s->peak_bytes = s->live_bytes;
+  return tag + 1;
+}
+
+void kheap_free(void *ptr) {
+  if (ptr == NULL) return;
+  kheap_tag_t *tag = (kheap_tag_t *) ptr - 1;
+  kheap_site_t *s = &kheap_sites[tag->site];
+  s->live_objects--;
+  s->live_bytes -= tag->size;
+  tag->site = tag->size = -1; // safety against double frees going unnoticed
+  free(tag);
+}
+
+#endif
+
+void kheap_info(kheap_info_t *info) {
+  memset(info, 0, sizeof(kheap_info_t));
+  info->heap_bytes = (unsigned int) kernel_pt.brk - (unsigned int) _kernel_orig_brk;
+  info->headroom_bytes = (DOWN_TO_PAGE(KERNEL_STACK_BASE) - PAGESIZE) - (unsigned int) kernel_pt.brk;
+#ifdef KHEAP_PROFILE
+  info->profiled = 1;
+  for (int site = 0; site < NUM_KH_SITES; site++) info->sites[site] = kheap_sites[site];
+#endif
+}
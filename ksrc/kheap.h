@@ -0,0 +1,55 @@
+/* Erich Woo & Boxian Wang
+ * 4 December 2020
+ * header file for kheap.c
+ *
+ * All kernel allocations go through kmalloc/kcalloc/kfree with a KH_* site tag
+ * (see ycustom.h). When built with KHEAP_PROFILE (make KHEAP_PROFILE=1), each
+ * allocation carries a small header recording its site and size, and live bytes,
+ * live objects and peak bytes are tracked per site. Otherwise the wrappers
+ * compile straight down to malloc/calloc/free.
+ */
+
+#ifndef __KHEAP_H
+#define __KHEAP_H
+
+#include <ykernel.h>
+#include "ycustom.h"
+
+#ifdef KHEAP_PROFILE
+#define kmalloc(size, site) kheap_alloc((size), (site), 0)
+#define kcalloc(n, size, site) kheap_alloc((n) * (size), (site), 1)
+#define kfree(ptr) kheap_free(ptr)
+#else
+#define kmalloc(size, site) malloc(size)
+#define kcalloc(n, size, site) calloc((n), (size))
+#define kfree(ptr) free(ptr)
+#endif
+
+/******************************* FUNCTION DECLARATIONS *****************************/
+
+#ifdef KHEAP_PROFILE
+/* Allocates size bytes on the kernel heap on behalf of the given site
+ *
+ * @param size the # of bytes wanted
+ * @param site the allocation site, one of KH_* in ycustom.h
+ * @param zero whether to zero the memory (calloc) or not (malloc)
+ * @return the allocated memory, NULL if out of kernel heap
+ */
+void *kheap_alloc(int size, int site, int zero);
+
+/* Frees memory allocated by kheap_alloc, crediting its site
+ * Does nothing if ptr is NULL
+ *
+ * @param ptr the memory to free
+ */
+void kheap_free(void *ptr);
+#endif
+
+/* Fills in the kernel heap usage: heap size and headroom always,
+ * and the per-site table if built with KHEAP_PROFILE
+ *
+ * @param info the kheap_info_t to fill in
+ */
+void kheap_info(kheap_info_t *info);
+
+#endif //__KHEAP_H
@@ -6,14 +6,14 @@
 #include "linked_list.h"
 
 ll_t* new_ll(void) {
-  ll_t* new = malloc(sizeof(ll_t));
+  ll_t* new = kmalloc(sizeof(ll_t), KH_LIST);
   new->head = new->tail = NULL;
   new->size = 0;
   return new;
 }
 
 node_t* new_node(void *data) {
-  node_t* new = malloc(sizeof(node_t));
+  node_t* new = kmalloc(sizeof(node_t), KH_NODE);
   new->data = data;
   new->next = new->prev = NULL;
   return new;
@@ -21,10 +21,10 @@ node_t* new_node(void *data) {
 
 void destroy_node(node_t *node) {
   if (node != NULL) {
-    free(node->data);
+    kfree(node->data);
     node->data = node->next = node->prev = NULL; // for safety
     node->code = -1;
-    free(node);
+    kfree(node);
     node = NULL;
   }
 }
@@ -73,6 +73,19 @@ void push(ll_t *list, node_t *n) {
   }
 }
 
+void splice(ll_t *dest, ll_t *src) {
+  if (dest == NULL || src == NULL || src->head == NULL) return;
+  if (dest->head == NULL) dest->head = src->head;
+  else {
+    dest->tail->next = src->head;
+    src->head->prev = dest->tail;
+  }
+  dest->tail = src->tail;
+  dest->size += src->size;
+  src->head = src->tail = NULL;
+  src->size = 0;
+}
+
 node_t* pop(ll_t *list) {
   if (list == NULL || list->size == 0) {
     TracePrintf(1, "Popping NULL or empty list\n");
@@ -140,3 +153,11 @@ node_t* find(ll_t *list, int code) {
   for (curr = list->head; curr != NULL && curr->code != code; curr = curr->next);
   return curr;
 }
+
+node_t* find_data(ll_t *list, void *data) {
+  if (list == NULL)
+    return NULL;
+  node_t *curr;
+  for (curr = list->head; curr != NULL && curr->data != data; curr = curr->next);
+  return curr;
+}
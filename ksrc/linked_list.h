@@ -7,6 +7,7 @@
 #define __LINKED_LIST_H
 
 #include "ykernel.h"
+#include "kheap.h"
 
 typedef struct node node_t;
 
@@ -77,6 +78,14 @@ void enqueue(ll_t *list, node_t *n);
  */
 void push(ll_t *list, node_t *n);
 
+/* Moves every node of src onto the tail of dest, in order, in constant time.
+ * src is left empty. Does nothing if either param is NULL
+ *
+ * @param dest the ll pointer to append to
+ * @param src the ll pointer to empty into dest
+ */
+void splice(ll_t *dest, ll_t *src);
+
 /* Dequeues and returns the head of the specified list
  * 
  * @param list the spceified ll pointer
@@ -114,4 +123,12 @@ int has_member(ll_t *list, node_t *n);
  */
 node_t* find(ll_t *list, int code);
 
+/* Finds and returns the node with specified data in the specified list
+ *
+ * @param list the specified ll pointer
+ * @param data the node's data to match/look for
+ * @return the found node, or NULL if not found, NULL list
+ */
+node_t* find_data(ll_t *list, void *data);
+
 #endif //__LINKED_LIST_H
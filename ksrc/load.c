@@ -16,6 +16,7 @@
 #include <load_info.h>
 
 #include "memory.h"
+#include "kheap.h"
 #include "process.h"
 
 /*
@@ -157,8 +158,11 @@ LoadProgram(char *name, char *args[], pcb_t *proc)
    * Now save the arguments in a separate buffer in region 0, since
    * we are about to blow away all of region 1.
    */
-  cp2 = argbuf = (char *)malloc(size);
-  if (cp2 == NULL) return ERROR;
+  cp2 = argbuf = (char *)kmalloc(size, KH_LOAD);
+  if (cp2 == NULL) {
+    close(fd);
+    return ERROR;
+  }
   /* 
    * ==>> You should perhaps check that malloc returned valid space 
    */
@@ -186,7 +190,11 @@ LoadProgram(char *name, char *args[], pcb_t *proc)
    * ==>> (See the LoadProgram diagram in the manual.)
    */
 
-  if (li.t_npg + data_npg + stack_npg > frames_left()) return KILL;
+  if (!enough_frames(li.t_npg + data_npg + stack_npg)) {
+    close(fd);
+    kfree(argbuf);
+    return KILL;
+  }
   proc->userpt->size = li.t_npg + data_npg + stack_npg;
 
   /*
@@ -196,7 +204,7 @@ LoadProgram(char *name, char *args[], pcb_t *proc)
    * ==>> (PROT_READ | PROT_WRITE).
    */
   for (int i = text_pg1; i < text_pg1 + li.t_npg; i++) {
-    set_pte(&proc->userpt->pt[i], 1, get_frame(NONE, AUTO), (PROT_READ | PROT_WRITE));
+    set_pte(&proc->userpt->pt[i], 1, get_frame(NONE, AUTO, proc->pid, FRAME_UTEXT), (PROT_READ | PROT_WRITE));
   }
 
   /*
@@ -206,7 +214,7 @@ LoadProgram(char *name, char *args[], pcb_t *proc)
    * ==>> (PROT_READ | PROT_WRITE).
    */
   for (int i = data_pg1; i < data_pg1 + data_npg; i++) {
-    set_pte(&proc->userpt->pt[i], 1, get_frame(NONE, AUTO), (PROT_READ | PROT_WRITE));
+    set_pte(&proc->userpt->pt[i], 1, get_frame(NONE, AUTO, proc->pid, FRAME_UDATA), (PROT_READ | PROT_WRITE));
   }
 
   /* 
@@ -217,7 +225,7 @@ LoadProgram(char *name, char *args[], pcb_t *proc)
    */
   
   for (int i = MAX_PT_LEN - 1; i >= MAX_PT_LEN - stack_npg; i--) {
-    set_pte(&proc->userpt->pt[i], 1, get_frame(NONE, AUTO), (PROT_READ | PROT_WRITE));
+    set_pte(&proc->userpt->pt[i], 1, get_frame(NONE, AUTO, proc->pid, FRAME_USTACK), (PROT_READ | PROT_WRITE));
   }
 
   proc->userpt->data_end = (void*) ((data_pg1 + data_npg + BASE_PAGE_1 - 1) << PAGESHIFT); // at least 1 above data start
@@ -239,6 +247,7 @@ LoadProgram(char *name, char *args[], pcb_t *proc)
   segment_size = li.t_npg << PAGESHIFT;
   if (read(fd, (void *) li.t_vaddr, segment_size) != segment_size) {
     close(fd);
+    kfree(argbuf);
     return KILL;   // see ykernel.h
   }
 
@@ -250,6 +259,7 @@ LoadProgram(char *name, char *args[], pcb_t *proc)
 
   if (read(fd, (void *) li.id_vaddr, segment_size) != segment_size) {
     close(fd);
+    kfree(argbuf);
     return KILL;
   }
 
@@ -306,7 +316,7 @@ LoadProgram(char *name, char *args[], pcb_t *proc)
     cp += strlen(cp) + 1;
     cp2 += strlen(cp2) + 1;
   }
-  free(argbuf);
+  kfree(argbuf);
   *cpp++ = NULL;			/* the last argv is a NULL pointer */
   *cpp++ = NULL;			/* a NULL pointer for an empty envp */
 
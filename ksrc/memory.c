@@ -28,19 +28,32 @@ void set_bit(unsigned char *bit_array, int index, int bit) {
 }
 
 int vacate_frame(unsigned int pfn) { // mark pfn as free
+  frame_info_t *f = &free_frame.info[pfn - BASE_FRAME];
+  if (f->refs > 1) { // still mapped elsewhere
+    f->refs--;
+    return 0;
+  }
+  f->refs = f->cow = 0;
   set_bit(free_frame.bit_vector, pfn - BASE_FRAME, 0);
+  set_frame_owner(pfn, KERNEL_OWNER, FRAME_FREE);
   free_frame.filled--;
   if (pfn < free_frame.avail_pfn) free_frame.avail_pfn = pfn;
   //TracePrintf(1, "freed frame %d\n", pfn);
   return 0;
 }
 
-int get_frame(unsigned int pfn, int auto_assign) { 
-  if (free_frame.filled >= free_frame.size) return ERROR;
+int get_frame(unsigned int pfn, int auto_assign, int pid, int purpose) { 
+  if (free_frame.filled >= free_frame.size) {
+    free_frame.failures++;
+    return ERROR;
+  }
   if (auto_assign)
     pfn = free_frame.avail_pfn;
   
   set_bit(free_frame.bit_vector, pfn - BASE_FRAME, 1);
+  set_frame_owner(pfn, pid, purpose);
+  free_frame.info[pfn - BASE_FRAME].refs = 1;
+  free_frame.info[pfn - BASE_FRAME].cow = 0;
   free_frame.filled++;
 
   // find next free 
@@ -58,6 +71,87 @@ int get_frame(unsigned int pfn, int auto_assign) {
   return pfn;
 }
 
+int share_frame(unsigned int pfn) {
+  free_frame.info[pfn - BASE_FRAME].refs++;
+  free_frame.info[pfn - BASE_FRAME].cow = 1;
+  return pfn;
+}
+
+int break_cow(user_pt_t *pt, int vpn) {
+  if (vpn < BASE_PAGE_1 || vpn >= LIM_PAGE_1) return 0;
+  pte_t *pte = &pt->pt[vpn - BASE_PAGE_1];
+  if (!pte->valid || (pte->prot & PROT_WRITE)) return 0;
+  frame_info_t *f = &free_frame.info[pte->pfn - BASE_FRAME];
+  if (!f->cow) return 0;
+  if (f->refs > 1) { // still shared, so take a private copy
+    int pfn = get_frame(NONE, AUTO, pt->pid, f->purpose);
+    if (pfn == ERROR) return ERROR;
+    int dummy = BASE_PAGE_KSTACK - 1;
+    set_pte(&kernel_pt.pt[dummy - BASE_PAGE_0], 1, pfn, PROT_READ|PROT_WRITE);
+    WriteRegister(REG_TLB_FLUSH, dummy << PAGESHIFT);
+    memcpy((void*) (dummy << PAGESHIFT), (void*) (vpn << PAGESHIFT), PAGESIZE);
+    set_pte(&kernel_pt.pt[dummy - BASE_PAGE_0], 0, NONE, NONE);
+    WriteRegister(REG_TLB_FLUSH, dummy << PAGESHIFT);
+    vacate_frame(pte->pfn); // drop our reference to the shared one
+    pte->pfn = pfn;
+  } else { // we're the last one holding it
+    f->cow = 0;
+    set_frame_owner(pte->pfn, pt->pid, f->purpose);
+  }
+  pte->prot = PROT_READ|PROT_WRITE;
+  WriteRegister(REG_TLB_FLUSH, vpn << PAGESHIFT);
+  return 1;
+}
+
+void set_frame_owner(unsigned int pfn, int pid, int purpose) {
+  free_frame.info[pfn - BASE_FRAME].pid = pid;
+  free_frame.info[pfn - BASE_FRAME].purpose = purpose;
+}
+
+// returns the slot of pid among info's owners, or -1 if it has none
+int owner_slot(mem_info_t *info, int pid) {
+  for (int o = 0; o < info->num_owners && o < MEMINFO_MAX_OWNERS; o++)
+    if (info->owners[o].pid == pid) return o;
+  return -1;
+}
+
+void mem_info(mem_info_t *info) {
+  memset(info, 0, sizeof(mem_info_t));
+  info->total_frames = free_frame.size;
+  info->free_frames = frames_left();
+  info->alloc_failures = free_frame.failures;
+  int run = 0, max_extra = -1; // the biggest pid that didn't get a slot
+  for (int i = 0; i < free_frame.size; i++) {
+    frame_info_t *f = &free_frame.info[i];
+    if (f->purpose == FRAME_FREE) { // extend the current free run
+      if (++run > info->largest_free_run) info->largest_free_run = run;
+      continue;
+    }
+    run = 0;
+    info->frames[f->purpose]++;
+    int o = owner_slot(info, f->pid);
+    if (o == -1 && info->num_owners < MEMINFO_MAX_OWNERS) { // first frame seen for this owner
+      o = info->num_owners++;
+      info->owners[o].pid = f->pid;
+    }
+    if (o != -1) info->owners[o].frames[f->purpose]++;
+    else if (f->pid > max_extra) max_extra = f->pid;
+  }
+  if (max_extra < 0) return;
+  // a second pass counts the owners beyond the table, marking their pids in a bitmap
+  char *seen = kcalloc(max_extra / CELL_SIZE + 1, sizeof(char), KH_FRAMES);
+  if (seen == NULL) return; // num_owners stays at MEMINFO_MAX_OWNERS
+  for (int i = 0; i < free_frame.size; i++) {
+    int pid = free_frame.info[i].pid;
+    if (free_frame.info[i].purpose == FRAME_FREE || pid < 0 || owner_slot(info, pid) != -1) continue;
+    if (!(seen[pid / CELL_SIZE] & (1 << (pid % CELL_SIZE)))) {
+      seen[pid / CELL_SIZE] |= 1 << (pid % CELL_SIZE);
+      info->num_owners++;
+    }
+  }
+  kfree(seen);
+}
+
 void set_pte(pte_t *pte, int valid, int pfn, int prot) {
   if (!(pte->valid = valid)) return; // turn off valid bit, others don't matter
   pte->pfn = pfn;
@@ -65,7 +159,7 @@ void set_pte(pte_t *pte, int valid, int pfn, int prot) {
 }
 
 int SetKernelBrk(void *addr) {
-  if ((unsigned int) addr >= DOWN_TO_PAGE(KERNEL_STACK_BASE) - PAGESIZE ||
+  if ((unsigned int) addr >= BASE_PAGE_WINDOW << PAGESHIFT || // leave the windows and scratch page alone
     (unsigned int) addr < UP_TO_PAGE(_kernel_data_end)) return ERROR;
 
   if (ReadRegister(REG_VM_ENABLE)) {
@@ -73,7 +167,7 @@ int SetKernelBrk(void *addr) {
     unsigned int next_brk_vpn = (UP_TO_PAGE(addr) >> PAGESHIFT) - 1; // greatest vpn to be used
     if (next_brk_vpn > curr_brk_vpn) {
       for (int vpn = curr_brk_vpn + 1; vpn <= next_brk_vpn; vpn++) {
-        set_pte(&kernel_pt.pt[vpn - BASE_PAGE_0], 1, get_frame(NONE, AUTO), PROT_READ|PROT_WRITE);
+        set_pte(&kernel_pt.pt[vpn - BASE_PAGE_0], 1, get_frame(NONE, AUTO, KERNEL_OWNER, FRAME_KHEAP), PROT_READ|PROT_WRITE);
         WriteRegister(REG_TLB_FLUSH, vpn << PAGESHIFT);
       }
     } else if (next_brk_vpn < curr_brk_vpn) {
@@ -89,20 +183,29 @@ int SetKernelBrk(void *addr) {
 }
 
 user_pt_t *new_user_pt(void) {
-  user_pt_t *new = malloc(sizeof(user_pt_t));
+  user_pt_t *new = kmalloc(sizeof(user_pt_t), KH_USER_PT);
   for (int vpn = BASE_PAGE_1; vpn < LIM_PAGE_1; vpn++) {
     set_pte(&new->pt[vpn - BASE_PAGE_1], 0, NONE, NONE);
   }
   new->size = 0;
+  new->pid = KERNEL_OWNER; // until a process claims it
   return new;
 }
 
-void copy_user_mem(user_pt_t *origin, user_pt_t *dst) {
+void copy_user_mem(user_pt_t *origin, user_pt_t *dst, int pid) {
   int dummy = BASE_PAGE_KSTACK - 1;
   for (int vpn = BASE_PAGE_1; vpn < LIM_PAGE_1; vpn++) {
       if (origin->pt[vpn-BASE_PAGE_1].valid) {
         int privilege = origin->pt[vpn-BASE_PAGE_1].prot;
-        set_pte(&kernel_pt.pt[dummy - BASE_PAGE_0], 1, get_frame(NONE, AUTO), PROT_READ|PROT_WRITE);
+        frame_info_t *f = &free_frame.info[origin->pt[vpn-BASE_PAGE_1].pfn - BASE_FRAME];
+        int purpose = f->purpose; // same use as parent's
+        if (purpose == FRAME_SHM) { // shared memory stays shared
+          dst->pt[vpn - BASE_PAGE_1] = origin->pt[vpn - BASE_PAGE_1];
+          f->refs++;
+          continue;
+        }
+        if (f->cow) privilege |= PROT_WRITE; // the child's copy is its own
+        set_pte(&kernel_pt.pt[dummy - BASE_PAGE_0], 1, get_frame(NONE, AUTO, pid, purpose), PROT_READ|PROT_WRITE);
         WriteRegister(REG_TLB_FLUSH, dummy << PAGESHIFT);
         memcpy((void*) (dummy << PAGESHIFT), (void*) (vpn << PAGESHIFT), PAGESIZE);
         dst->pt[vpn - BASE_PAGE_1] = kernel_pt.pt[dummy - BASE_PAGE_0];
@@ -116,6 +219,111 @@ void copy_user_mem(user_pt_t *origin, user_pt_t *dst) {
   dst->stack_low = origin->stack_low;
 }
 
+void copy_to_user(user_pt_t *dst_pt, char *dst, char *src, int len) {
+  int dummy = BASE_PAGE_KSTACK - 1;
+  while (len > 0) {
+    int vpn = (unsigned int) dst >> PAGESHIFT, offset = (unsigned int) dst & PAGEOFFSET;
+    int chunk = PAGESIZE - offset < len ? PAGESIZE - offset : len; // rest of this page
+    set_pte(&kernel_pt.pt[dummy - BASE_PAGE_0], 1, dst_pt->pt[vpn - BASE_PAGE_1].pfn, PROT_READ|PROT_WRITE);
+    WriteRegister(REG_TLB_FLUSH, dummy << PAGESHIFT);
+    memcpy((void*) ((dummy << PAGESHIFT) + offset), src, chunk);
+    dst += chunk;
+    src += chunk;
+    len -= chunk;
+  }
+  set_pte(&kernel_pt.pt[dummy - BASE_PAGE_0], 0, NONE, NONE);
+  WriteRegister(REG_TLB_FLUSH, dummy << PAGESHIFT);
+}
+
+void copy_from_frame(char *dst, int pfn, int offset, int len) {
+  int dummy = BASE_PAGE_KSTACK - 1;
+  set_pte(&kernel_pt.pt[dummy - BASE_PAGE_0], 1, pfn, PROT_READ);
+  WriteRegister(REG_TLB_FLUSH, dummy << PAGESHIFT);
+  memcpy(dst, (void*) ((dummy << PAGESHIFT) + offset), len);
+  set_pte(&kernel_pt.pt[dummy - BASE_PAGE_0], 0, NONE, NONE);
+  WriteRegister(REG_TLB_FLUSH, dummy << PAGESHIFT);
+}
+
+char *map_window(int tty_id, user_pt_t *pt, char *addr, int len) {
+  int window = BASE_PAGE_WINDOW + tty_id * TTY_WINDOW_PAGES;
+  int first = (unsigned int) addr >> PAGESHIFT, last = ((unsigned int) addr + len - 1) >> PAGESHIFT;
+  for (int vpn = first; vpn <= last; vpn++) {
+    int wvpn = window + vpn - first;
+    set_pte(&kernel_pt.pt[wvpn - BASE_PAGE_0], 1, pt->pt[vpn - BASE_PAGE_1].pfn, PROT_READ);
+    WriteRegister(REG_TLB_FLUSH, wvpn << PAGESHIFT);
+  }
+  return (char *) ((window << PAGESHIFT) + ((unsigned int) addr & PAGEOFFSET));
+}
+
+void unmap_window(int tty_id) {
+  int window = BASE_PAGE_WINDOW + tty_id * TTY_WINDOW_PAGES;
+  for (int wvpn = window; wvpn < window + TTY_WINDOW_PAGES; wvpn++) {
+    set_pte(&kernel_pt.pt[wvpn - BASE_PAGE_0], 0, NONE, NONE);
+    WriteRegister(REG_TLB_FLUSH, wvpn << PAGESHIFT);
+  }
+}
+
+unsigned int user_paddr(user_pt_t *pt, void *addr) {
+  int vpn = (unsigned int) addr >> PAGESHIFT;
+  return (pt->pt[vpn - BASE_PAGE_1].pfn << PAGESHIFT) | ((unsigned int) addr & PAGEOFFSET);
+}
+
+void zero_frame(int pfn) {
+  int dummy = BASE_PAGE_KSTACK - 1;
+  set_pte(&kernel_pt.pt[dummy - BASE_PAGE_0], 1, pfn, PROT_READ|PROT_WRITE);
+  WriteRegister(REG_TLB_FLUSH, dummy << PAGESHIFT);
+  memset((void*) (dummy << PAGESHIFT), 0, PAGESIZE);
+  set_pte(&kernel_pt.pt[dummy - BASE_PAGE_0], 0, NONE, NONE);
+  WriteRegister(REG_TLB_FLUSH, dummy << PAGESHIFT);
+}
+
+int pages_free(user_pt_t *pt, int first, int lim) {
+  if (first < BASE_PAGE_1) first = BASE_PAGE_1;
+  if (lim > LIM_PAGE_1) lim = LIM_PAGE_1;
+  for (int vpn = first; vpn < lim; vpn++) if (pt->pt[vpn - BASE_PAGE_1].valid) return 0;
+  return 1;
+}
+
+int map_shared(user_pt_t *pt, int *pfns, int npages, void *addr) {
+  int low = (UP_TO_PAGE(pt->brk) >> PAGESHIFT) + 1; // a page above the heap
+  int high = (DOWN_TO_PAGE(pt->stack_low) >> PAGESHIFT) - 1; // a page below the stack
+  int first = ERROR;
+  if (addr != NULL) {
+    int vpn = (unsigned int) addr >> PAGESHIFT;
+    if (!((unsigned int) addr & PAGEOFFSET) && vpn >= low && vpn + npages <= high &&
+	pages_free(pt, vpn - 1, vpn + npages + 1)) first = vpn;
+  } else { // first fit from halfway up, leaving both heap and stack room to grow
+    int mid = (low + high) / 2;
+    for (int vpn = mid; first == ERROR && vpn + npages <= high; vpn++)
+      if (pages_free(pt, vpn - 1, vpn + npages + 1)) first = vpn;
+    for (int vpn = low; first == ERROR && vpn < mid && vpn + npages <= high; vpn++)
+      if (pages_free(pt, vpn - 1, vpn + npages + 1)) first = vpn;
+  }
+  if (first == ERROR) return ERROR;
+  for (int i = 0; i < npages; i++) {
+    set_pte(&pt->pt[first + i - BASE_PAGE_1], 1, pfns[i], PROT_READ|PROT_WRITE);
+    free_frame.info[pfns[i] - BASE_FRAME].refs++;
+    WriteRegister(REG_TLB_FLUSH, (first + i) << PAGESHIFT);
+  }
+  return first << PAGESHIFT;
+}
+
+int is_shared(user_pt_t *pt, int vpn) {
+  pte_t *pte = &pt->pt[vpn - BASE_PAGE_1];
+  return pte->valid && free_frame.info[pte->pfn - BASE_FRAME].purpose == FRAME_SHM;
+}
+
+int unmap_shared(user_pt_t *pt, void *addr) {
+  int vpn = (unsigned int) addr >> PAGESHIFT;
+  if (((unsigned int) addr & PAGEOFFSET) || vpn < BASE_PAGE_1 || vpn >= LIM_PAGE_1 ||
+      !is_shared(pt, vpn) || (vpn > BASE_PAGE_1 && is_shared(pt, vpn - 1))) return ERROR;
+  for (; vpn < LIM_PAGE_1 && is_shared(pt, vpn); vpn++) { // attachments are never adjacent
+    set_pte(&pt->pt[vpn - BASE_PAGE_1], 0, vacate_frame(pt->pt[vpn - BASE_PAGE_1].pfn), NONE);
+    WriteRegister(REG_TLB_FLUSH, vpn << PAGESHIFT);
+  }
+  return 0;
+}
+
 // vacate all user frames
 void destroy_usermem(user_pt_t *userpt) {
   for (int vpn = BASE_PAGE_1; vpn < LIM_PAGE_1; vpn++) {
@@ -135,14 +343,12 @@ void destroy_kstack(kernel_stack_pt_t* kstack) { // don't do this in the same pr
 
 int check_addr(void *addr, int prot, user_pt_t* curr_pt) {
   if ((unsigned int) addr < VMEM_1_BASE || (unsigned int) addr >= VMEM_1_LIMIT) return 0; // dont touch kernel!
-  pte_t p = curr_pt->pt[((unsigned int)addr >> PAGESHIFT) - BASE_PAGE_1];
+  int vpn = (unsigned int) addr >> PAGESHIFT;
+  pte_t p = curr_pt->pt[vpn - BASE_PAGE_1];
   if (!p.valid) return 0; // must be valid
-  if ((p.prot == PROT_READ|PROT_WRITE) || (p.prot == PROT_ALL)) return 1;
-  if (prot == PROT_READ) {
-    return (p.prot == PROT_READ);
-  } else {
-    return (p.prot == PROT_WRITE);
-  }
+  // the kernel is about to write here, so a shared copy-on-write page must become ours first
+  if ((prot & PROT_WRITE) && !(p.prot & PROT_WRITE) && break_cow(curr_pt, vpn) == 1) return 1;
+  return (p.prot & prot) == prot;
 }
 
 int check_buffer(int len, void *addr, int prot, user_pt_t* curr_pt) {
@@ -167,10 +373,34 @@ int check_args(char** args, user_pt_t* curr_pt) {
   return 0;
 }
 
+char **dup_args(char **args) {
+  int argc, size = 0;
+  for (argc = 0; args[argc] != NULL; argc++) size += strlen(args[argc]) + 1;
+  char **copy = kmalloc((argc + 1) * sizeof(char *) + size, KH_LOAD);
+  if (copy == NULL) return NULL;
+  char *str = (char *) (copy + argc + 1); // strings go right after the pointers
+  for (int i = 0; i < argc; i++) {
+    copy[i] = strcpy(str, args[i]);
+    str += strlen(str) + 1;
+  }
+  copy[argc] = NULL;
+  return copy;
+}
+
 int no_kernel_memory(int left) {
-  return (frames_left() < left || (unsigned int) kernel_pt.brk >= DOWN_TO_PAGE(KERNEL_STACK_BASE) - PAGESIZE);
+  if (frames_left() < left || (unsigned int) kernel_pt.brk >= BASE_PAGE_WINDOW << PAGESHIFT) {
+    free_frame.failures++;
+    return 1;
+  }
+  return 0;
 }
 
 int frames_left(void) { 
   return free_frame.size - free_frame.filled;
 }
+
+int enough_frames(int n) {
+  if (n <= frames_left()) return 1;
+  free_frame.failures++;
+  return 0;
+}
@@ -7,6 +7,8 @@
 #define __MEMORY_H
 
 #include <ykernel.h>
+#include "ycustom.h"
+#include "kheap.h"
 
 #define NUM_PAGES_1 (VMEM_1_SIZE / PAGESIZE)
 #define NUM_PAGES_0 (VMEM_0_SIZE / PAGESIZE)
@@ -18,6 +20,9 @@
 #define BASE_PAGE_KSTACK (KERNEL_STACK_BASE >> PAGESHIFT)
 #define LIM_PAGE_KSTACK (KERNEL_STACK_LIMIT >> PAGESHIFT)
 #define BASE_FRAME (PMEM_BASE >> PAGESHIFT)
+#define TTY_WINDOW_PAGES 2 // kernel window pages per terminal, for transmitting out of user frames
+// first page of the terminals' kernel windows, just below the scratch page under the kernel stack
+#define BASE_PAGE_WINDOW (BASE_PAGE_KSTACK - 1 - NUM_TERMINALS * TTY_WINDOW_PAGES)
 
 #define CELL_SIZE (sizeof(char) << 3)
 
@@ -27,11 +32,20 @@
 
 #define MAX_CHECK 256 // max len of arg or string
 
+typedef struct frame_info { // who owns a physical frame, and for what
+  short pid; // owner pid, KERNEL_OWNER for the kernel itself
+  unsigned char purpose; // FRAME_* in ycustom.h, FRAME_FREE if unused
+  unsigned char cow; // 1 if shared copy-on-write: its read-only user mappings are really writable
+  short refs; // # of page table entries/pipes holding it; freed when this drops to 0
+} frame_info_t;
+
 typedef struct f_frame { // tracking which frames in physical are free
   int size; // available number of physical frames
   unsigned char * bit_vector; // pointer to a bit vector
+  frame_info_t *info; // owner/purpose of each frame, indexed by pfn - BASE_FRAME
   unsigned int avail_pfn; // next available pfn
   int filled;
+  int failures; // # of refused allocations
 } free_frame_t;
 
 typedef struct user_pt { // userland page table
@@ -40,6 +54,7 @@ typedef struct user_pt { // userland page table
   void *stack_low; // top of the user stack
   pte_t pt[NUM_PAGES_1]; // actual entries  
   int size; // num physical pages                                                               
+  int pid; // the owning process, for frame tracking
 } user_pt_t;
 
 typedef struct kernel_stack_pt { // kernel stack page_table
@@ -62,21 +77,58 @@ typedef struct kernel_global_pt { // includes code, data, heap
  */
 void set_pte(pte_t *pte, int valid, int pfn, int prot);
 
-/* Vacates the specified fram
+/* Drops a reference to the specified frame. Once no references are left,
+ * vacates the frame, clearing its owner
  *
  * @param the frame to vacate
  * @return 0
  */
 int vacate_frame(unsigned int pfn);
 
-/* Gets a free physical frame, marks it as occupied, 
- * and returns the frame #
+/* Adds a reference to the specified frame and marks it copy-on-write,
+ * for mapping it somewhere else without copying
+ *
+ * @param pfn the frame to share
+ * @return pfn
+ */
+int share_frame(unsigned int pfn);
+
+/* Gives the current process a writable page at vpn if it's a read-only
+ * mapping of a copy-on-write frame: copies the frame if it's still shared,
+ * otherwise just restores write access
+ *
+ * @param pt the current process' user page table
+ * @param vpn the page #
+ * @return 1 if the page was copy-on-write and is now writable, 0 if it isn't
+ *         copy-on-write, ERROR if no frames left to copy into
+ */
+int break_cow(user_pt_t *pt, int vpn);
+
+/* Gets a free physical frame, marks it as occupied by 
+ * the specified owner and purpose, and returns the frame #
  *
  * @param pfn page frame #
  * @param auto_assign whether to assign automatically or not
- * @return the frame # gotten
+ * @param pid the owner pid, KERNEL_OWNER for the kernel
+ * @param purpose what the frame is for, one of FRAME_* in ycustom.h
+ * @return the frame # gotten, ERROR if no frames left
  */
-int get_frame(unsigned int pfn, int auto_assign);
+int get_frame(unsigned int pfn, int auto_assign, int pid, int purpose);
+
+/* Changes the recorded owner and purpose of an occupied frame
+ *
+ * @param pfn page frame #
+ * @param pid the new owner pid
+ * @param purpose the new purpose
+ */
+void set_frame_owner(unsigned int pfn, int pid, int purpose);
+
+/* Summarizes physical memory usage by owner and purpose. Owners beyond
+ * MEMINFO_MAX_OWNERS get no slot but are still counted in num_owners
+ *
+ * @param info the mem_info_t to fill in
+ */
+void mem_info(mem_info_t *info);
 
 /* Sets the new kernel break to addr
  *
@@ -95,8 +147,101 @@ user_pt_t *new_user_pt(void);
  *
  * @param origin the original user page table
  * @param dst the destination user page table
+ * @param pid the pid owning dst, for frame tracking
+ */
+void copy_user_mem(user_pt_t *origin, user_pt_t *dst, int pid);
+
+/* Copies len bytes from src (in the current address space) to dst in another
+ * process' region 1, a page at a time through the kernel's scratch page
+ * Assumes [dst, dst + len) was already checked valid in dst_pt
+ *
+ * @param dst_pt the other process' user page table
+ * @param dst the destination address in the other process' region 1
+ * @param src the source address
+ * @param len the # of bytes to copy
+ */
+void copy_to_user(user_pt_t *dst_pt, char *dst, char *src, int len);
+
+/* Copies len bytes starting offset bytes into physical frame pfn
+ * to dst in the current address space, through the kernel's scratch page
+ *
+ * @param dst the destination address
+ * @param pfn the source frame
+ * @param offset where in the frame to start
+ * @param len the # of bytes to copy, at most PAGESIZE - offset
+ */
+void copy_from_frame(char *dst, int pfn, int offset, int len);
+
+/* Maps the user frames holding [addr, addr + len) into terminal tty_id's
+ * kernel window, so they stay readable after switching away from their process
+ * Assumes [addr, addr + len) was already checked valid in pt, and len <= PAGESIZE
+ *
+ * @param tty_id whose window to use
+ * @param pt the user page table addr is in
+ * @param addr the user address
+ * @param len the # of bytes needed
+ * @return where addr can be read in the window
+ */
+char *map_window(int tty_id, user_pt_t *pt, char *addr, int len);
+
+/* Unmaps terminal tty_id's kernel window
+ *
+ * @param tty_id whose window to unmap
+ */
+void unmap_window(int tty_id);
+
+/* Returns the physical address behind a (checked) user address
+ *
+ * @param pt the user page table addr is in
+ * @param addr the user address
+ * @return its physical address
+ */
+unsigned int user_paddr(user_pt_t *pt, void *addr);
+
+/* Zeroes physical frame pfn, through the kernel's scratch page
+ *
+ * @param pfn the frame
+ */
+void zero_frame(int pfn);
+
+/* Returns whether user pages [first, lim) are all unmapped
+ *
+ * @param pt the user page table
+ * @param first the first vpn
+ * @param lim one past the last vpn
+ * @return 1 if all unmapped (or out of region 1 below/above), 0 otherwise
+ */
+int pages_free(user_pt_t *pt, int first, int lim);
+
+/* Maps the given FRAME_SHM frames, in order and read/write, into consecutive pages
+ * between the heap and the stack, adding a reference to each. Keeps at least one
+ * unmapped page between them and the heap, the stack, or any other attachment
+ *
+ * @param pt the user page table
+ * @param pfns the frames
+ * @param npages the # of frames
+ * @param addr the page-aligned address to map at, NULL to pick one
+ * @return the address mapped at, ERROR if addr isn't usable or nothing fits
  */
-void copy_user_mem(user_pt_t *origin, user_pt_t *dst);
+int map_shared(user_pt_t *pt, int *pfns, int npages, void *addr);
+
+/* Unmaps the shared memory attachment starting at addr, dropping its frames' references
+ *
+ * @param pt the user page table
+ * @param addr where map_shared() mapped it
+ * @return 0 on success, ERROR if no attachment starts at addr
+ */
+int unmap_shared(user_pt_t *pt, void *addr);
+
+/* Returns whether the page vpn maps a shared memory frame. Such pages
+ * are never flipped or shared copy-on-write: their attachers must keep
+ * writing to the same frame
+ *
+ * @param pt the user page table
+ * @param vpn a page number in region 1
+ * @return 1 if it's a FRAME_SHM page, 0 otherwise
+ */
+int is_shared(user_pt_t *pt, int vpn);
 
 /* Destroys user memory for the specified user page table,
  * vacating all user frames
@@ -151,6 +296,15 @@ int check_string(char* addr, user_pt_t* curr_pt);
  */
 int check_args(char** args, user_pt_t* curr_pt);
 
+/* Copies the given (already checked) NULL-terminated arg vector into
+ * a single block on the kernel heap, strings included.
+ * Must be kfree'd later by caller
+ *
+ * @param args the arg vector to copy
+ * @return the kernel copy of args, NULL if out of kernel heap
+ */
+char **dup_args(char **args);
+
 /* Returns whether there are 'left' enough free frames and 
  * if the kbrk hasn't reached the kstack yet
  *
@@ -165,4 +319,12 @@ int no_kernel_memory(int left);
  */
 int frames_left(void);
 
+/* Returns whether there are at least n free frames left,
+ * counting an allocation failure if not
+ *
+ * @param n the # of frames about to be allocated
+ * @return 1 if enough frames, 0 if not
+ */
+int enough_frames(int n);
+
 #endif //__MEMORY_H
@@ -12,176 +12,618 @@ extern pilocvar_t *pilocvar;
   
 extern proc_table_t *procs;
 
+// the physical frame tracker, for flipping pages through pipes
+extern free_frame_t free_frame;
+
 // The storage bookkeeper for all terminals
 extern io_control_t *io;
 
 /************************** FUNCTIIONS **************************/
 
-// buffer
+// tty io
 
-buffer_t *new_buffer(int size) {
-  buffer_t *new = malloc(sizeof(buffer_t));
-  new->buffered = calloc(size, sizeof(char));
-  new->size = size;
-  new->filled = new->head = new->tail = 0;
+ttyio_t *new_ttyio(int size) {
+  ttyio_t *new = kmalloc(sizeof(ttyio_t), KH_TTY);
+  new->blocked = new_ll();
+  new->pollers = new_ll();
+  new->buffer = new_buffer(size, size);
+  new->transmitting = 0;
+  new->waiters = 0;
+  new->waking = 0;
+  new->direct = 0;
+  new->lines = NULL;
+  new->line_head = 0;
+  new->line_count = 0;
   return new;
 }
 
-int write_buffer(buffer_t *buffer, char *src, int len) {
-  int avail = buffer->size - buffer->filled;
-  int written = avail < len ? avail : len;
-  for (int i = 0; i < written; i++) 
-    buffer->buffered[(buffer->tail + i) % buffer->size] = src[i];
-  buffer->tail = (buffer->tail + written) % buffer->size;
-  buffer->filled += written;
-  return written;
-} 
-
-int read_buffer(buffer_t *buffer, char *dst, int len) {
-  int read = buffer->filled < len ? buffer->filled : len;
-  for (int i = 0; i < read; i++) {
-    dst[i] = buffer->buffered[(buffer->head + i) % buffer->size];
+io_control_t *io_control_init(int out_ring, int in_ring) {
+  io_control_t *io = kmalloc(sizeof(io_control_t), KH_TTY);
+  for (int i = 0; i < NUM_TERMINALS; i++) {
+    io->in[i] = new_ttyio(in_ring);
+    io->in[i]->lines = kmalloc(TTY_IN_LINES * sizeof(int), KH_TTY);
+    io->out[i]= new_ttyio(out_ring);
   }
-  buffer->head = (buffer->head + read) % buffer->size;
-  buffer->filled -= read;
-  return read;
-} 
+  for (int i = 0; i < MAX_PTYS; i++) io->pty[i] = NULL;
+  return io;
+}
 
-void reset_buffer(buffer_t *buffer) {
-  buffer->filled = buffer->head = buffer->tail = 0;
+// starts transmitting the next chunk of the terminal's output ring, if idle and there is one
+void transmit_next(int tty_id) {
+  ttyio_t *out = io->out[tty_id];
+  if (out->transmitting) return;
+  int len = read_buffer(out->buffer, io->transmit_buffer[tty_id], TERMINAL_MAX_LINE);
+  if (len == 0) return;
+  out->transmitting = 1;
+  TtyTransmit(tty_id, io->transmit_buffer[tty_id], len);
 }
 
-void destroy_buffer(buffer_t *buffer) {
-  buffer->size = 0;      // safety
-  reset_buffer(buffer);
-  free(buffer->buffered);
-  buffer->buffered = NULL;
-  free(buffer);
-  buffer = NULL;
+// wakes the writer at the head of the terminal's queue, unless one is already on its way
+void wake_tty_writer(ttyio_t *out) {
+  if (out->waking || is_empty(out->blocked)) return;
+  out->waking = 1;
+  unblock_head(out->blocked);
 }
 
-// tty io
+// transmits len bytes a chunk at a time straight out of the running writer's frames,
+// through the terminal's kernel window. The caller must hold the terminal (out->waiters)
+void transmit_direct(int tty_id, char *src, int len) {
+  ttyio_t *out = io->out[tty_id];
+  user_pt_t *pt = ((pcb_t *) procs->running->data)->userpt;
+  for (int total = 0; total < len; ) {
+    int chunk = len - total < TERMINAL_MAX_LINE ? len - total : TERMINAL_MAX_LINE;
+    out->transmitting = 1;
+    out->direct = 1;
+    TtyTransmit(tty_id, map_window(tty_id, pt, src + total, chunk), chunk);
+    h_block(out->blocked); // write_alert wakes the head
+    total += chunk;
+  }
+  unmap_window(tty_id);
+}
 
-ttyio_t *new_ttyio(void) {
-  ttyio_t *new = malloc(sizeof(ttyio_t));
-  new->blocked = new_ll();
-  new->buffer = new_buffer(TERMINAL_MAX_LINE); // subject to change
-  new->transmitting = 0;
-  return new;
+// transmits len bytes straight out of the running writer's frames,
+// holding the terminal until done
+int write_tty_direct(int tty_id, char *src, int len) {
+  ttyio_t *out = io->out[tty_id];
+  out->waiters++; // everyone else queues behind us
+  transmit_direct(tty_id, src, len);
+  out->waiters--;
+  wake_tty_writer(out);
+  wake_pollers(out->pollers); // write_alert skipped them while we held the terminal
+  return len;
 }
 
-io_control_t *io_control_init(void) {
-  io_control_t *io = malloc(sizeof(io_control_t));
-  for (int i = 0; i < NUM_TERMINALS; i++) {
-    io->in[i] = new_ttyio();
-    io->out[i]= new_ttyio();
+int write_tty(int tty_id, char *src, int len, int flags) {
+  ttyio_t *out = io->out[tty_id];
+  int total = 0;
+
+  if (len >= TTY_DIRECT_MIN && !(flags & IO_NONBLOCK) && (unsigned int) src >= VMEM_1_BASE &&
+      out->waiters == 0 && !out->transmitting && out->buffer->filled == 0)
+    return write_tty_direct(tty_id, src, len); // nothing to order behind, so no need to copy
+
+  if (out->waiters == 0) total = write_buffer(out->buffer, src, len); // nobody queued ahead of us
+  transmit_next(tty_id);
+  if (total == len) return total;
+  if (flags & IO_NONBLOCK) return total > 0 ? total : WOULD_BLOCK;
+
+  out->waiters++;
+  block(out->blocked); // wait our turn
+  while (1) {
+    out->waking = 0;
+    total += write_buffer(out->buffer, src + total, len - total);
+    transmit_next(tty_id);
+    if (total == len) break;
+    h_block(out->blocked); // still our turn once there's room again
   }
-  return io;
+  out->waiters--;
+  if (out->buffer->filled < out->buffer->cap) wake_tty_writer(out); // room left for the next one
+  return total;
 }
 
-int write_tty(int tty_id, char *src, int len) {
+int writev_tty(int tty_id, io_vec_t *iov, int n, int flags) {
   ttyio_t *out = io->out[tty_id];
-  int written, total = 0;
-
-  while (total < len) {
-    if (out->transmitting) {
-      block(out->blocked);
-    } else {
-      reset_buffer(out->buffer);
-      written = write_buffer(out->buffer, src, len);
-      total += written;
-      src += written; 
-      out->transmitting = 1;
-      TtyTransmit(tty_id, out->buffer->buffered, written);
-      h_block(out->blocked); // the one which made the last write shall always be at the head of the queue, for fast wake up
+  int total = 0;
+  if (flags & IO_NONBLOCK) { // nothing runs in between, so the segments can't be interleaved anyway
+    for (int i = 0; i < n; i++) {
+      int w = write_tty(tty_id, iov[i].base, iov[i].len, flags);
+      if (w == WOULD_BLOCK) break;
+      total += w;
+      if (w < iov[i].len) break;
     }
+    return total > 0 ? total : WOULD_BLOCK;
   }
-  if (!is_empty(out->blocked)) unblock_head(out->blocked); // see if next wants to write
+  if (out->waiters++ > 0) { // wait our turn, then keep it for every segment
+    block(out->blocked);
+    out->waking = 0;
+  }
+  for (int i = 0; i < n; i++) {
+    char *src = iov[i].base;
+    int len = iov[i].len, done = 0;
+    if (len >= TTY_DIRECT_MIN && (unsigned int) src >= VMEM_1_BASE && !out->transmitting && out->buffer->filled == 0) {
+      transmit_direct(tty_id, src, len); // idle terminal: no need to copy
+      done = len;
+    }
+    while (done < len) {
+      done += write_buffer(out->buffer, src + done, len - done);
+      transmit_next(tty_id);
+      if (done == len) break;
+      h_block(out->blocked); // still our turn once there's room again
+      out->waking = 0;
+    }
+    total += len;
+  }
+  out->waiters--;
+  if (out->buffer->filled < out->buffer->cap) wake_tty_writer(out); // room left for the next one
+  wake_pollers(out->pollers);
   return total;
 }
 
 void write_alert(int tty_id) {
   ttyio_t *out = io->out[tty_id];
-  reset_buffer(out->buffer);
   out->transmitting = 0;
-  if (!is_empty(out->blocked)) unblock_head(out->blocked);
+  if (out->direct) { // the writer we were transmitting from is at the head, and sends its next chunk
+    out->direct = 0;
+    unblock_head(out->blocked);
+    return;
+  }
+  transmit_next(tty_id);
+  wake_tty_writer(out);
+  wake_pollers(out->pollers); // writable again
 }
 
-int read_tty(int tty_id, char *dst, int len) {
-  int read;
-  ttyio_t *in = io->in[tty_id];
-  while ((read = read_buffer(in->buffer, dst, len)) == 0) {
+// wakes the reader at the head of the terminal's queue, unless one is already on its way
+void wake_tty_reader(ttyio_t *in) {
+  if (in->waking || is_empty(in->blocked)) return;
+  in->waking = 1;
+  unblock_head(in->blocked);
+}
+
+int read_tty(int tty_id, char *dst, int len, int flags) {
+  return read_lines(io->in[tty_id], dst, len, flags);
+}
+
+int read_lines(ttyio_t *in, char *dst, int len, int flags) {
+  if (in->line_count == 0) {
+    if (flags & IO_NONBLOCK) return WOULD_BLOCK;
     block(in->blocked); // will be woken up in trap
+    in->waking = 0;
+    while (in->line_count == 0) { // someone got here first
+      h_block(in->blocked); // still first in line
+      in->waking = 0;
+    }
+  }
+  int *line = &in->lines[in->line_head];
+  int read = read_buffer(in->buffer, dst, len < *line ? len : *line);
+  *line -= read;
+  if (*line == 0) { // done with this line
+    in->line_head = (in->line_head + 1) % TTY_IN_LINES;
+    in->line_count--;
   }
+  if (in->line_count > 0) wake_tty_reader(in); // pass it on
   return read;
 }
 
+// queues one line of input, recording its boundary, and returns how much of it fit
+int add_line(ttyio_t *in, char *src, int len) {
+  int real_rd = write_buffer(in->buffer, src, len);
+  if (real_rd == 0) return 0;
+  if (in->line_count == TTY_IN_LINES) // out of line records, join the last line
+    in->lines[(in->line_head + in->line_count - 1) % TTY_IN_LINES] += real_rd;
+  else in->lines[(in->line_head + in->line_count++) % TTY_IN_LINES] = real_rd;
+  return real_rd;
+}
+
 void receive(int tty_id) {
+  ttyio_t *in = io->in[tty_id];
   int read = TtyReceive(tty_id, io->landing_buffer, TERMINAL_MAX_LINE); // receive in landing buffer
-  int real_rd = write_buffer(io->in[tty_id]->buffer, io->landing_buffer, read);
-  if (real_rd > 0) unblock_all(io->in[tty_id]->blocked); // we got something, bois
+  if (add_line(in, io->landing_buffer, read) == 0) return;
+  wake_tty_reader(in);
+  wake_pollers(in->pollers);
+}
+
+// pty
+
+int new_pty(void) {
+  int i;
+  for (i = 0; i < MAX_PTYS && io->pty[i] != NULL; i++);
+  if (i == MAX_PTYS) return ERROR;
+  pty_t *pty = kmalloc(sizeof(pty_t), KH_TTY);
+  pty->in = new_ttyio(PTY_RING);
+  pty->in->lines = kmalloc(TTY_IN_LINES * sizeof(int), KH_TTY);
+  pty->out = new_buffer(PTY_RING, PTY_RING);
+  pty->out_readers = new_ll();
+  pty->out_writers = new_ll();
+  pty->unfulfilled = 0;
+  io->pty[i] = pty;
+  return NUM_TERMINALS + i;
+}
+
+pty_t *find_pty(int pty_id) {
+  if (pty_id < NUM_TERMINALS || pty_id >= NUM_TERMINALS + MAX_PTYS) return NULL;
+  return io->pty[pty_id - NUM_TERMINALS];
+}
+
+int destroy_pty(int pty_id) {
+  pty_t *pty = find_pty(pty_id);
+  if (pty == NULL || !is_empty(pty->in->blocked) || !is_empty(pty->out_readers) || !is_empty(pty->out_writers) ||
+      !is_empty(pty->in->pollers) || pty->in->waking || pty->unfulfilled > 0) return ERROR; // someone's still on the way in
+  destroy_buffer(pty->in->buffer);
+  kfree(pty->in->blocked);
+  kfree(pty->in->pollers);
+  kfree(pty->in->lines);
+  kfree(pty->in);
+  destroy_buffer(pty->out);
+  kfree(pty->out_readers);
+  kfree(pty->out_writers);
+  kfree(pty);
+  io->pty[pty_id - NUM_TERMINALS] = NULL;
+  return 0;
+}
+
+// wakes everyone on one of the pty's output lists, counting them until they run
+void wake_pty(pty_t *pty, ll_t *blocked) {
+  pty->unfulfilled += get_size(blocked);
+  unblock_all(blocked);
+}
+
+int read_pty(pty_t *pty, char *dst, int len, int flags) {
+  int read;
+  while ((read = read_buffer(pty->out, dst, len)) == 0) {
+    if (flags & IO_NONBLOCK) return WOULD_BLOCK;
+    block(pty->out_readers);
+    pty->unfulfilled--;
+  }
+  wake_pty(pty, pty->out_writers); // there's room now
+  wake_pollers(pty->in->pollers);
+  return read;
+}
+
+int write_pty(pty_t *pty, char *src, int len) {
+  ttyio_t *in = pty->in;
+  int total = 0;
+  while (total < len) {
+    int line = 0; // up to and including the newline, at most a terminal's line like TtyReceive
+    while (total + line < len && line < TERMINAL_MAX_LINE && src[total + line++] != '\n');
+    if (in->buffer->cap - in->buffer->filled < line || in->line_count == TTY_IN_LINES) break; // only whole lines
+    total += add_line(in, src + total, line);
+  }
+  if (total > 0) {
+    wake_tty_reader(in);
+    wake_pollers(in->pollers);
+  }
+  return total;
+}
+
+int write_pty_slave(pty_t *pty, char *src, int len, int flags) {
+  int total = 0;
+  while (1) {
+    int written = write_buffer(pty->out, src + total, len - total);
+    total += written;
+    if (written > 0) {
+      wake_pty(pty, pty->out_readers);
+      wake_pollers(pty->in->pollers);
+    }
+    if (total == len) return total;
+    if (flags & IO_NONBLOCK) return total > 0 ? total : WOULD_BLOCK;
+    block(pty->out_writers);
+    pty->unfulfilled--;
+  }
+}
+
+int read_pty_slave(pty_t *pty, char *dst, int len, int flags) {
+  int read = read_lines(pty->in, dst, len, flags);
+  if (read > 0) wake_pollers(pty->in->pollers); // room for the master to type more
+  return read;
+}
+
+// futex
+
+int futex_wait(unsigned int paddr, int *addr, int val) {
+  if (*addr != val) return FUTEX_CHANGED; // no one can change it between here and blocking
+  procs->running->code = paddr;
+  block(pilocvar->futex[(paddr >> 2) % FUTEX_BUCKETS]);
+  return 0;
+}
+
+int futex_wake(unsigned int paddr, int n) {
+  ll_t *bucket = pilocvar->futex[(paddr >> 2) % FUTEX_BUCKETS];
+  node_t *curr, *next;
+  int woken = 0;
+  for (curr = bucket->head; curr != NULL && woken < n; curr = next) {
+    next = curr->next; // unblocking moves curr onto the ready queue
+    if ((unsigned int) curr->code != paddr) continue;
+    unblock(bucket, curr);
+    woken++;
+  }
+  return woken;
 }
 
 // pipe
 
-node_t *new_pipe(int id) {
-  pipe_t *p = malloc(sizeof(pipe_t));
-  p->buffer = new_buffer(PIPE_BUFFER_LEN);
+// accounts for written bytes just put into the pipe's buffer
+void note_pipe_write(pipe_t *pipe, int written) {
+  pipe->stat.bytes_written += written;
+  if (pipe->buffer->filled > pipe->stat.high_water) pipe->stat.high_water = pipe->buffer->filled;
+}
+
+node_t *new_pipe(int id, int cap) {
+  pipe_t *p = kmalloc(sizeof(pipe_t), KH_IPC);
+  p->buffer = new_buffer(cap < PIPE_BUFFER_LEN ? cap : PIPE_BUFFER_LEN, cap); // grows on demand
   p->readblocked = new_ll();
   p->writeblocked = new_ll();
-  p->unfulfilled = 0;
+  p->unfulfilled = p->promised_data = p->promised_space = 0;
+  p->pages = new_ll();
+  p->page_off = p->page_bytes = 0;
+  p->pollers = new_ll();
+  memset(&p->stat, 0, sizeof(pipe_stat_t));
   node_t *n = new_node(p);
   n->code = id;
   enqueue(pilocvar->pipe, n);
   return n;
 }
 
-int write_pipe(node_t *pipe_n, char *src, int len) {
+// wakes blocked readers in FIFO order, as long as there's unpromised data for them
+void wake_readers(pipe_t *pipe) {
+  int avail = pipe->page_bytes + pipe->buffer->filled - pipe->promised_data;
+  if (avail > 0) wake_pollers(pipe->pollers);
+  while (avail > 0 && !is_empty(pipe->readblocked)) {
+    node_t *reader = pipe->readblocked->head;
+    int grant = reader->code < avail ? reader->code : avail;
+    reader->code = grant;
+    avail -= grant;
+    pipe->promised_data += grant;
+    pipe->unfulfilled++; // now a process is in limbo
+    unblock_head(pipe->readblocked);
+  }
+}
+
+// wakes blocked writers in FIFO order, as long as the head's need fits in unpromised space
+void wake_writers(pipe_t *pipe) {
+  int space = pipe->buffer->cap - pipe->buffer->filled - pipe->promised_space;
+  if (space > 0) wake_pollers(pipe->pollers);
+  while (!is_empty(pipe->writeblocked)) {
+    node_t *writer = pipe->writeblocked->head;
+    int need = writer->code < pipe->buffer->cap ? writer->code : pipe->buffer->cap; // cap may have shrunk
+    if (need > space) break; // keep FIFO order
+    writer->code = need;
+    space -= need;
+    pipe->promised_space += need;
+    pipe->unfulfilled++; // now a process is in limbo
+    unblock_head(pipe->writeblocked);
+  }
+}
+
+int set_pipe_cap(node_t *pipe_n, int cap) {
   pipe_t *pipe = pipe_n->data;
-  int total, written = 0;
+  if (cap < 1 || cap > PIPE_MAX_CAPACITY) return ERROR;
+  int old_cap = pipe->buffer->cap;
+  if (set_buffer_cap(pipe->buffer, cap) == ERROR) return ERROR;
+  if (cap > old_cap) wake_writers(pipe); // room for more now
+  return 0;
+}
+
+// copies straight into blocked readers' buffers, while the pipe is empty
+// returns the # of bytes handed off
+int handoff_pipe(pipe_t *pipe, char *src, int len) {
+  int total = 0;
+  while (len > 0 && pipe->buffer->filled == 0 && pipe->page_bytes == 0 && !is_empty(pipe->readblocked)) {
+    node_t *reader = pipe->readblocked->head;
+    io_wait_t *w = &((pcb_t *) reader->data)->wait;
+    int n = w->len < len ? w->len : len;
+    copy_to_user(((pcb_t *) reader->data)->userpt, w->buf, src, n);
+    w->done = n;
+    src += n;
+    len -= n;
+    total += n;
+    reader->code = 0; // no buffered data promised
+    pipe->unfulfilled++; // now a process is in limbo
+    unblock_head(pipe->readblocked);
+  }
+  pipe->stat.bytes_written += total;
+  pipe->stat.handoff_bytes += total;
+  return total;
+}
+
+// moves the writer's whole pages at src into the pipe's page queue, sharing the frames
+// copy-on-write instead of copying them. Only while the buffer is empty, to keep bytes in order
+// returns the # of bytes flipped in
+int flip_pages_in(pipe_t *pipe, char *src, int len) {
+  if (((unsigned int) src & PAGEOFFSET) || len < PIPE_FLIP_MIN || pipe->buffer->filled > 0) return 0;
+  if ((unsigned int) src < VMEM_1_BASE) return 0; // only user pages can be flipped
+  user_pt_t *pt = ((pcb_t *) procs->running->data)->userpt;
+  int total = 0;
+  while (len - total >= PAGESIZE && get_size(pipe->pages) < PIPE_FLIP_MAX_PAGES) {
+    int vpn = ((unsigned int) src + total) >> PAGESHIFT;
+    pte_t *pte = &pt->pt[vpn - BASE_PAGE_1];
+    if (!(pte->prot & PROT_WRITE) && !free_frame.info[pte->pfn - BASE_FRAME].cow) break; // not a data page
+    if (is_shared(pt, vpn)) break; // the other attachers could still change it: copy instead
+    node_t *page = new_node(NULL);
+    page->code = share_frame(pte->pfn);
+    enqueue(pipe->pages, page);
+    pte->prot = PROT_READ; // our next write breaks the sharing
+    WriteRegister(REG_TLB_FLUSH, vpn << PAGESHIFT);
+    total += PAGESIZE;
+  }
+  pipe->page_bytes += total;
+  pipe->stat.bytes_written += total;
+  pipe->stat.flipped_bytes += total;
+  return total;
+}
+
+// reads up to len bytes from the pipe's page queue into dst: whole pages are mapped
+// straight into the reader where dst is page-aligned, the rest is copied
+// returns the # of bytes read
+int read_pages(pipe_t *pipe, char *dst, int len) {
+  user_pt_t *pt = ((pcb_t *) procs->running->data)->userpt;
+  int total = 0;
+  while (total < len && !is_empty(pipe->pages)) {
+    node_t *page = pipe->pages->head;
+    char *at = dst + total;
+    int n;
+    int vpn = (unsigned int) at >> PAGESHIFT;
+    if (pipe->page_off == 0 && !((unsigned int) at & PAGEOFFSET) && len - total >= PAGESIZE &&
+        vpn >= BASE_PAGE_1 && vpn < LIM_PAGE_1 && !is_shared(pt, vpn)) { // flip it in, but copy into shm for the other attachers
+      pte_t *pte = &pt->pt[vpn - BASE_PAGE_1];
+      frame_info_t *f = &free_frame.info[page->code - BASE_FRAME];
+      int purpose = free_frame.info[pte->pfn - BASE_FRAME].purpose;
+      vacate_frame(pte->pfn); // our old page goes, the pipe's reference becomes ours
+      if (f->refs == 1) { // nobody else has it anymore
+        f->cow = 0;
+        set_frame_owner(page->code, pt->pid, purpose);
+      }
+      set_pte(pte, 1, page->code, f->cow ? PROT_READ : PROT_READ|PROT_WRITE);
+      WriteRegister(REG_TLB_FLUSH, vpn << PAGESHIFT);
+      n = PAGESIZE;
+    } else {
+      n = PAGESIZE - pipe->page_off < len - total ? PAGESIZE - pipe->page_off : len - total;
+      copy_from_frame(at, page->code, pipe->page_off, n);
+      pipe->page_off += n;
+      if (pipe->page_off == PAGESIZE) vacate_frame(page->code); // done with the pipe's reference
+    }
+    total += n;
+    pipe->page_bytes -= n;
+    if (n == PAGESIZE || pipe->page_off == PAGESIZE) { // head page used up
+      destroy_node(dequeue(pipe->pages));
+      pipe->page_off = 0;
+    }
+  }
+  return total;
+}
+
+// reads up to len bytes from the pipe: the flipped pages first, then the buffer
+int read_pipe_data(pipe_t *pipe, char *dst, int len) {
+  int read = read_pages(pipe, dst, len);
+  return read + read_buffer(pipe->buffer, dst + read, len - read);
+}
+
+int write_pipe(node_t *pipe_n, char *src, int len, int flags) {
+  pipe_t *pipe = pipe_n->data;
+  int total = 0, written, woken = 0;
   int len_left = len;
+
+  // big page-aligned writes: pass the frames themselves
+  written = flip_pages_in(pipe, src, len_left);
+  // rendezvous: readers are already waiting on an empty pipe, so skip the buffer
+  written += handoff_pipe(pipe, src + written, len_left - written);
+  src += written;
+  total += written;
+  len_left -= written;
+  if (len_left == 0) {
+    wake_readers(pipe);
+    return total;
+  }
   
   // write as much as space allowed in buffer, block if need to write more
-  while ((written = write_buffer(pipe->buffer, src, len)) < len_left) {
+  while ((written = write_buffer(pipe->buffer, src, len_left)) < len_left) {
     src += written; // move to rights
     total += written;
     len_left -= written;
+    note_pipe_write(pipe, written);
+    if (woken && written == 0) pipe->stat.wasted_wakeups++; // someone beat us to the space
+    wake_readers(pipe); // they must drain what we've put in so far
+    if (flags & IO_NONBLOCK) return total > 0 ? total : WOULD_BLOCK; // short write
+    pipe->stat.write_blocks++;
+    procs->running->code = len_left; // wait until the rest fits (or the pipe is empty)
     block(pipe->writeblocked);
     pipe->unfulfilled--; // now I wake up and check things (fulfilled)
+    pipe->promised_space -= procs->running->code;
+    woken = 1;
   }
-  // done writing, so unblock readers
-  if (!is_empty(pipe->readblocked)) {
-    pipe->unfulfilled += get_size(pipe->readblocked); // now a process is in limbo
-    unblock_all(pipe->readblocked); // now a process is in limbo
-  }
+  total += written;
+  note_pipe_write(pipe, written);
+  // done writing, so wake readers that now have data
+  wake_readers(pipe);
   return total;
 }
 
 // assume len > 0
-int read_pipe(node_t *pipe_n, char *dst, int len) {
+int read_pipe(node_t *pipe_n, char *dst, int len, int flags) {
   pipe_t *pipe = pipe_n->data;
   int read;
 
   // read at most len from buffer, block if 0 read
-  while ((read = read_buffer(pipe->buffer, dst, len)) == 0) {
+  int woken = 0;
+  io_wait_t *w = &((pcb_t *) procs->running->data)->wait;
+  while ((read = read_pipe_data(pipe, dst, len)) == 0) {
+    if (flags & IO_NONBLOCK) return WOULD_BLOCK;
+    pipe->stat.wasted_wakeups += woken; // someone beat us to the data
+    pipe->stat.read_blocks++;
+    procs->running->code = len;
+    w->buf = dst; // so a writer can hand us data directly
+    w->len = len;
+    w->done = 0;
     block(pipe->readblocked); // I'm blockeds
     pipe->unfulfilled--; // now I wake up and check things (fulfilled)
+    pipe->promised_data -= procs->running->code;
+    w->buf = NULL;
+    if ((read = w->done) > 0) break; // a writer already copied into dst
+    woken = 1;
   }
-  // done reading, so unblock writers
-  if (!is_empty(pipe->writeblocked)) {
-    pipe->unfulfilled += get_size(pipe->writeblocked); // now a process is in limbo
-    unblock_all(pipe->writeblocked);
-  }
+  pipe->stat.bytes_read += read;
+  // done reading, so wake writers whose need now fits
+  wake_writers(pipe);
   return read;
 }
 
+int writev_pipe(node_t *pipe_n, io_vec_t *iov, int n, int flags) {
+  pipe_t *pipe = pipe_n->data;
+  int total = 0, written = 0;
+  for (int i = 0; i < n; i++) total += iov[i].len;
+  if (total <= pipe->buffer->cap) { // wait until it all fits, then write it without blocking
+    while (pipe->buffer->cap - pipe->buffer->filled < total) {
+      if (flags & IO_NONBLOCK) return WOULD_BLOCK;
+      pipe->stat.write_blocks++;
+      procs->running->code = total;
+      block(pipe->writeblocked);
+      pipe->unfulfilled--;
+      pipe->promised_space -= procs->running->code;
+    }
+  }
+  for (int i = 0; i < n; i++) {
+    if (iov[i].len == 0) continue;
+    int w = write_pipe(pipe_n, iov[i].base, iov[i].len, flags);
+    if (w == WOULD_BLOCK) break; // only when too big to fit at once
+    written += w;
+    if (w < iov[i].len) break; // short nonblocking write
+  }
+  return (written > 0 || total == 0) ? written : WOULD_BLOCK;
+}
+
+int readv_pipe(node_t *pipe_n, io_vec_t *iov, int n, int flags) {
+  pipe_t *pipe = pipe_n->data;
+  int i;
+  for (i = 0; i < n && iov[i].len == 0; i++);
+  if (i == n) return 0;
+  int read = read_pipe(pipe_n, iov[i].base, iov[i].len, flags); // blocks for the first bytes
+  if (read < iov[i].len) return read; // got all there was, or WOULD_BLOCK
+  int more = 0;
+  for (i++; i < n; i++) { // then take whatever else is there
+    int r = read_pipe_data(pipe, iov[i].base, iov[i].len);
+    more += r;
+    if (r < iov[i].len) break;
+  }
+  if (more > 0) {
+    pipe->stat.bytes_read += more;
+    wake_writers(pipe);
+  }
+  return read + more;
+}
+
 int destroy_pipe(node_t *pipe_n) {
   pipe_t *pipe = pipe_n->data;
-  if (!is_empty(pipe->readblocked) || !is_empty(pipe->writeblocked) || pipe->unfulfilled > 0) return ERROR;
+  if (!is_empty(pipe->readblocked) || !is_empty(pipe->writeblocked) || pipe->unfulfilled > 0 ||
+      !is_empty(pipe->pollers)) return ERROR;
   // free insides
+  while (!is_empty(pipe->pages)) {
+    node_t *page = dequeue(pipe->pages);
+    vacate_frame(page->code);
+    destroy_node(page);
+  }
+  kfree(pipe->pages);
+  kfree(pipe->pollers);
   destroy_buffer(pipe->buffer);
-  free(pipe->readblocked);
-  free(pipe->writeblocked);
+  kfree(pipe->readblocked);
+  kfree(pipe->writeblocked);
   pipe->readblocked = pipe->writeblocked = NULL;
   pipe->unfulfilled = 0;
   // free node
@@ -194,34 +636,57 @@ int destroy_pipe(node_t *pipe_n) {
 /// lock
 
 node_t *new_lock(int id) {
-  lock_t *l = malloc(sizeof(pipe_t));
+  lock_t *l = kmalloc(sizeof(lock_t), KH_IPC);
   l->owner = NULL;
   l->blocked = new_ll();
   l->unfulfilled = l->cvar = 0;
+  l->mode = LOCK_MESA;
+  memset(&l->stat, 0, sizeof(lock_stat_t));
   node_t *n = new_node(l);
   n->code = id;
   enqueue(pilocvar->lock, n);
   return n;
 }
 
-int acquire(node_t *lock_n) {
+int acquire(node_t *lock_n, int timeout) {
   lock_t *lock = lock_n->data;
+  int start = procs->ticks, blocked = 0;
   while (!(lock->owner == NULL || lock->owner == procs->running)) {
+    if (timeout == 0) {
+      lock->stat.timeouts++;
+      return TIMEDOUT;
+    }
+    blocked = 1;
+    if (timeout != WAIT_FOREVER) arm_timer(timeout, lock->blocked);
     block(lock->blocked); // mesa style
+    if (timeout != WAIT_FOREVER) {
+      timeout = disarm_timer(procs->running);
+      if (((pcb_t *) procs->running->data)->timed_out) continue; // timeout is 0 now
+    }
     lock->unfulfilled--; // now I wake up and check things (fulfilled)
+    if (!(lock->owner == NULL || lock->owner == procs->running)) lock->stat.wasted_wakeups++;
   }
   lock->owner = procs->running;
+  lock->stat.acquires++;
+  if (blocked) { // account for the time spent waiting
+    int waited = procs->ticks - start;
+    lock->stat.contended++;
+    lock->stat.blocked_ticks += waited;
+    if (waited > lock->stat.max_blocked_ticks) lock->stat.max_blocked_ticks = waited;
+  }
   return 0;
 }
 
 int release(node_t *lock_n) {
   lock_t *lock = lock_n->data;
   if (lock->owner != procs->running) return ERROR;
+  lock->owner = NULL;
   if (!is_empty(lock->blocked)) {
+    lock->stat.wakeups++;
+    if (lock->mode == LOCK_HANDOFF) lock->owner = lock->blocked->head; // it's theirs before they even run
     unblock_head(lock->blocked);
     lock->unfulfilled++; // now a process is in limbo
   }
-  lock->owner = NULL;
   return 0;
 }
 
@@ -230,7 +695,7 @@ int destroy_lock(node_t *lock_n) {
   if (lock->owner != NULL || !is_empty(lock->blocked) || 
     lock->unfulfilled > 0 || lock->cvar > 0) return ERROR; // cant destroy easily!
   // destroy contents
-  free(lock->blocked);
+  kfree(lock->blocked);
   lock->owner = NULL;
   lock->blocked = NULL;
   lock->unfulfilled = lock->cvar = 0;
@@ -242,40 +707,73 @@ int destroy_lock(node_t *lock_n) {
 }
 
 node_t *new_cvar(int id) {
-  cvar_t *c = malloc(sizeof(pipe_t));
+  cvar_t *c = kmalloc(sizeof(cvar_t), KH_IPC);
   c->blocked = new_ll();
+  memset(&c->stat, 0, sizeof(cvar_stat_t));
   node_t *n = new_node(c);
   n->code = id;
   enqueue(pilocvar->cvar, n);
   return n;
 }
 
+// moves the head waiter of the cvar to its lock: straight to ready as the owner
+// if the lock is free, otherwise onto the lock's queue to be woken by release()
+void morph_head(cvar_t *cvar) {
+  node_t *w = dequeue(cvar->blocked);
+  disarm_timer(w); // signaled in time
+  lock_t *lock = ((pcb_t *) w->data)->cvar_lock->data;
+  if (lock->owner == NULL) {
+    lock->owner = w;
+    w->code = 0; // not from the lock's queue
+    ready(w);
+  } else {
+    w->code = 1; // release() will count it as unfulfilled
+    enqueue(lock->blocked, w);
+  }
+}
+
 void signal_cvar(node_t *cvar_n) {
   cvar_t *cvar = cvar_n->data;
-  if (!is_empty(cvar->blocked)) unblock_head(cvar->blocked);
+  cvar->stat.signals++;
+  if (!is_empty(cvar->blocked)) morph_head(cvar);
 }
 
 void broadcast(node_t *cvar_n) {
   cvar_t *cvar = cvar_n->data;
-  if (!is_empty(cvar->blocked)) unblock_all(cvar->blocked);
+  cvar->stat.broadcasts++;
+  while (!is_empty(cvar->blocked)) morph_head(cvar);
 }
 
 // must have the lock!!! error checking done at a higher level
-void wait_cvar(node_t *cvar_n, node_t *lock_n) {
+int wait_cvar(node_t *cvar_n, node_t *lock_n, int timeout) {
   cvar_t *cvar = cvar_n->data;
   lock_t *lock = lock_n->data;
+  pcb_t *p = procs->running->data;
+  int rc = 0;
   release(lock_n);
   lock->cvar++; // I want to use this later, don't destroy yet
-  block(cvar->blocked);
-  acquire(lock_n); // hopefully still there
+  cvar->stat.waits++;
+  p->cvar_lock = lock_n;
+  p->timed_out = 0;
+  if (timeout != WAIT_FOREVER) arm_timer(timeout, cvar->blocked);
+  block(cvar->blocked); // signal/broadcast morph us onto the lock
+  p->cvar_lock = NULL;
+  if (p->timed_out) { // straight off the cvar, never signaled
+    cvar->stat.timeouts++;
+    rc = TIMEDOUT;
+  } else if (procs->running->code) lock->unfulfilled--; // woken by release()
+  if (!(lock->owner == NULL || lock->owner == procs->running))
+    cvar->stat.spurious++; // woken up only to block on the lock again
+  acquire(lock_n, WAIT_FOREVER); // usually already ours
   lock->cvar--; // no more cvar waiting on it
+  return rc;
 }
 
 int destroy_cvar(node_t *cvar_n) {
   lock_t *cvar = cvar_n->data;
   if (!is_empty(cvar->blocked)) return ERROR; // cant destroy easily!
   // destroy contents
-  free(cvar->blocked);
+  kfree(cvar->blocked);
   cvar->blocked = NULL;
   // destroy node
   remove(pilocvar->cvar, cvar_n);
@@ -284,14 +782,207 @@ int destroy_cvar(node_t *cvar_n) {
   return 0;
 }
 
+/// rwlock
+
+node_t *new_rwlock(int id) {
+  rwlock_t *rw = kmalloc(sizeof(rwlock_t), KH_IPC);
+  rw->writer = NULL;
+  rw->readers = new_ll();
+  rw->readblocked = new_ll();
+  rw->writeblocked = new_ll();
+  memset(&rw->stat, 0, sizeof(rwlock_stat_t));
+  node_t *n = new_node(rw);
+  n->code = id;
+  enqueue(pilocvar->rwlock, n);
+  return n;
+}
+
+// records a read hold by the given process
+void add_reader(rwlock_t *rw, node_t *proc) {
+  node_t *r = new_node(NULL);
+  r->code = get_pid(proc);
+  enqueue(rw->readers, r);
+}
+
+void read_acquire(node_t *rw_n) {
+  rwlock_t *rw = rw_n->data;
+  rw->stat.read_acquires++;
+  if (rw->writer == NULL && is_empty(rw->writeblocked)) {
+    add_reader(rw, procs->running);
+    return;
+  }
+  rw->stat.read_blocks++;
+  block(rw->readblocked); // a writer's release adds us to the readers
+}
+
+void write_acquire(node_t *rw_n) {
+  rwlock_t *rw = rw_n->data;
+  rw->stat.write_acquires++;
+  if (rw->writer == NULL && is_empty(rw->readers)) {
+    rw->writer = procs->running;
+    return;
+  }
+  rw->stat.write_blocks++;
+  block(rw->writeblocked); // the last release makes us the writer
+}
+
+// hands the free rwlock to the next writer, if any
+void admit_writer(rwlock_t *rw) {
+  if (is_empty(rw->writeblocked)) return;
+  rw->writer = rw->writeblocked->head;
+  unblock_head(rw->writeblocked);
+}
+
+int rw_release(node_t *rw_n) {
+  rwlock_t *rw = rw_n->data;
+  if (rw->writer == procs->running) {
+    rw->writer = NULL;
+    if (is_empty(rw->readblocked)) {
+      admit_writer(rw);
+      return 0;
+    }
+    int batch = get_size(rw->readblocked); // everyone who queued behind us, even with writers waiting
+    for (node_t *r = rw->readblocked->head; r != NULL; r = r->next) add_reader(rw, r);
+    unblock_all(rw->readblocked);
+    rw->stat.batches++;
+    if (batch > rw->stat.max_batch) rw->stat.max_batch = batch;
+    return 0;
+  }
+  node_t *r = find(rw->readers, get_pid(procs->running));
+  if (r == NULL) return ERROR;
+  kfree(remove(rw->readers, r)); // not destroy_node(): it has no data
+  if (is_empty(rw->readers)) admit_writer(rw);
+  return 0;
+}
+
+int destroy_rwlock(node_t *rw_n) {
+  rwlock_t *rw = rw_n->data;
+  if (rw->writer != NULL || !is_empty(rw->readers) ||
+      !is_empty(rw->readblocked) || !is_empty(rw->writeblocked)) return ERROR; // cant destroy easily!
+  kfree(rw->readers);
+  kfree(rw->readblocked);
+  kfree(rw->writeblocked);
+  remove(pilocvar->rwlock, rw_n);
+  destroy_node(rw_n);
+  return 0;
+}
+
+/// sem
+
+node_t *new_sem(int id, int count) {
+  sem_t *s = kmalloc(sizeof(sem_t), KH_IPC);
+  s->count = count;
+  s->blocked = new_ll();
+  memset(&s->stat, 0, sizeof(sem_stat_t));
+  node_t *n = new_node(s);
+  n->code = id;
+  enqueue(pilocvar->sem, n);
+  return n;
+}
+
+void sem_down(node_t *sem_n) {
+  sem_t *s = sem_n->data;
+  s->stat.downs++;
+  if (s->count > 0) {
+    s->count--;
+    return;
+  }
+  s->stat.blocks++;
+  block(s->blocked); // sem_up gives us its unit directly
+}
+
+void sem_up(node_t *sem_n) {
+  sem_t *s = sem_n->data;
+  s->stat.ups++;
+  if (is_empty(s->blocked)) s->count++;
+  else unblock_head(s->blocked); // no one can take it in between
+}
+
+int destroy_sem(node_t *sem_n) {
+  sem_t *s = sem_n->data;
+  if (!is_empty(s->blocked)) return ERROR; // cant destroy easily!
+  kfree(s->blocked);
+  remove(pilocvar->sem, sem_n);
+  destroy_node(sem_n);
+  return 0;
+}
+
+/// barrier
+
+node_t *new_barrier(int id, int n) {
+  barrier_t *b = kmalloc(sizeof(barrier_t), KH_IPC);
+  b->n = n;
+  b->blocked = new_ll();
+  memset(&b->stat, 0, sizeof(barrier_stat_t));
+  node_t *node = new_node(b);
+  node->code = id;
+  enqueue(pilocvar->barrier, node);
+  return node;
+}
+
+void barrier_wait(node_t *barrier_n) {
+  barrier_t *b = barrier_n->data;
+  b->stat.waits++;
+  if (get_size(b->blocked) + 1 < b->n) {
+    block(b->blocked);
+    return;
+  }
+  b->stat.releases++;
+  unblock_all(b->blocked); // one splice, and the list is empty for the next round
+}
+
+int destroy_barrier(node_t *barrier_n) {
+  barrier_t *b = barrier_n->data;
+  if (!is_empty(b->blocked)) return ERROR; // cant destroy easily!
+  kfree(b->blocked);
+  remove(pilocvar->barrier, barrier_n);
+  destroy_node(barrier_n);
+  return 0;
+}
+
+/// shm
+
+node_t *new_shm(int id, int npages) {
+  if (!enough_frames(npages)) return NULL;
+  shm_t *shm = kmalloc(sizeof(shm_t), KH_IPC);
+  shm->npages = npages;
+  shm->pfns = kmalloc(npages * sizeof(int), KH_IPC);
+  for (int i = 0; i < npages; i++) {
+    shm->pfns[i] = get_frame(NONE, AUTO, KERNEL_OWNER, FRAME_SHM);
+    zero_frame(shm->pfns[i]);
+  }
+  node_t *n = new_node(shm);
+  n->code = id;
+  enqueue(pilocvar->shm, n);
+  return n;
+}
+
+int destroy_shm(node_t *shm_n) {
+  shm_t *shm = shm_n->data;
+  for (int i = 0; i < shm->npages; i++) vacate_frame(shm->pfns[i]); // freed here unless still attached
+  kfree(shm->pfns);
+  remove(pilocvar->shm, shm_n);
+  destroy_node(shm_n);
+  return 0;
+}
+
+node_t *find_shm(int id) {
+  return find(pilocvar->shm, id);
+}
+
 /// pilocvar
 
 pilocvar_t *pilocvar_init(void) {
-  pilocvar_t *p = malloc(sizeof(pilocvar_t));
+  pilocvar_t *p = kmalloc(sizeof(pilocvar_t), KH_IPC);
   p->count = 0;
   p->pipe = new_ll();
   p->lock = new_ll();
   p->cvar = new_ll();
+  p->rwlock = new_ll();
+  p->sem = new_ll();
+  p->barrier = new_ll();
+  for (int i = 0; i < FUTEX_BUCKETS; i++) p->futex[i] = new_ll();
+  p->shm = new_ll();
   return p;
 }
 
@@ -311,4 +1002,149 @@ node_t *find_cvar(int id) {
   return find(pilocvar->cvar, id);
 }
 
+node_t *find_rwlock(int id) {
+  return find(pilocvar->rwlock, id);
+}
+
+node_t *find_sem(int id) {
+  return find(pilocvar->sem, id);
+}
+
+node_t *find_barrier(int id) {
+  return find(pilocvar->barrier, id);
+}
+
+// fills in stat from the pipe/lock/cvar/rwlock/sem/barrier node n of the given type
+void fill_stat(node_t *n, int type, ipc_stat_t *stat) {
+  stat->id = n->code;
+  stat->type = type;
+  if (type == IPC_PIPE) {
+    stat->u.pipe = ((pipe_t *) n->data)->stat;
+    stat->u.pipe.capacity = ((pipe_t *) n->data)->buffer->cap;
+    stat->contention = stat->u.pipe.read_blocks + stat->u.pipe.write_blocks;
+  } else if (type == IPC_LOCK) {
+    stat->u.lock = ((lock_t *) n->data)->stat;
+    stat->contention = stat->u.lock.contended;
+  } else if (type == IPC_RWLOCK) {
+    stat->u.rwlock = ((rwlock_t *) n->data)->stat;
+    stat->contention = stat->u.rwlock.read_blocks + stat->u.rwlock.write_blocks;
+  } else if (type == IPC_SEM) {
+    stat->u.sem = ((sem_t *) n->data)->stat;
+    stat->u.sem.count = ((sem_t *) n->data)->count;
+    stat->contention = stat->u.sem.blocks;
+  } else if (type == IPC_BARRIER) {
+    stat->u.barrier = ((barrier_t *) n->data)->stat;
+    stat->u.barrier.n = ((barrier_t *) n->data)->n;
+    stat->contention = stat->u.barrier.waits - stat->u.barrier.releases; // the ones that blocked
+  } else {
+    stat->u.cvar = ((cvar_t *) n->data)->stat;
+    stat->contention = stat->u.cvar.spurious;
+  }
+}
+
+int stat_ipc(int id, ipc_stat_t *stat) {
+  node_t *n;
+  if ((n = find_pipe(id)) != NULL) fill_stat(n, IPC_PIPE, stat);
+  else if ((n = find_lock(id)) != NULL) fill_stat(n, IPC_LOCK, stat);
+  else if ((n = find_cvar(id)) != NULL) fill_stat(n, IPC_CVAR, stat);
+  else if ((n = find_rwlock(id)) != NULL) fill_stat(n, IPC_RWLOCK, stat);
+  else if ((n = find_sem(id)) != NULL) fill_stat(n, IPC_SEM, stat);
+  else if ((n = find_barrier(id)) != NULL) fill_stat(n, IPC_BARRIER, stat);
+  else return ERROR;
+  return 0;
+}
+
+int list_ipc(ipc_stat_t *stats, int max) {
+  ll_t *lists[6] = {pilocvar->pipe, pilocvar->lock, pilocvar->cvar, pilocvar->rwlock, pilocvar->sem, pilocvar->barrier};
+  int types[6] = {IPC_PIPE, IPC_LOCK, IPC_CVAR, IPC_RWLOCK, IPC_SEM, IPC_BARRIER};
+  int total = 0;
+  for (int i = 0; i < 6; i++) {
+    for (node_t *curr = lists[i]->head; curr != NULL; curr = curr->next, total++)
+      if (total < max) fill_stat(curr, types[i], &stats[total]);
+  }
+  return total;
+}
+
 // to destroy pilocvar, call the functions above in the syscall
+
+// poll
+
+void wake_pollers(ll_t *pollers) {
+  while (!is_empty(pollers)) {
+    node_t *proxy = dequeue(pollers);
+    proxy->code = 0; // detached; the poller frees it
+    node_t *proc = proxy->data;
+    if (has_member(procs->polling, proc)) unblock(procs->polling, proc); // may already be woken by another
+  }
+}
+
+int poll_scan(poll_entry_t *fds, int n) {
+  int ready = 0;
+  for (int i = 0; i < n; i++) {
+    poll_entry_t *e = &fds[i];
+    e->revents = 0;
+    if (e->kind == POLL_PIPE) {
+      node_t *pipe_n = find_pipe(e->id);
+      if (pipe_n == NULL) return ERROR;
+      pipe_t *pipe = pipe_n->data;
+      if (pipe->page_bytes + pipe->buffer->filled > 0) e->revents |= POLL_IN;
+      if (pipe->buffer->filled < pipe->buffer->cap) e->revents |= POLL_OUT;
+    } else if (e->kind == POLL_PTY || (e->kind == POLL_TTY && e->id >= NUM_TERMINALS)) {
+      pty_t *pty = find_pty(e->id);
+      if (pty == NULL) return ERROR;
+      if (e->kind == POLL_TTY) { // the slave side, like a terminal
+        if (pty->in->line_count > 0) e->revents |= POLL_IN;
+        if (pty->out->filled < pty->out->cap) e->revents |= POLL_OUT;
+      } else { // the master side
+        if (pty->out->filled > 0) e->revents |= POLL_IN;
+        if (pty->in->buffer->filled < pty->in->buffer->cap && pty->in->line_count < TTY_IN_LINES)
+          e->revents |= POLL_OUT;
+      }
+    } else if (e->kind == POLL_TTY) {
+      if (e->id < 0) return ERROR;
+      if (io->in[e->id]->buffer->filled > 0) e->revents |= POLL_IN;
+      ttyio_t *out = io->out[e->id];
+      if (out->waiters == 0 && out->buffer->filled < out->buffer->cap) e->revents |= POLL_OUT;
+    } else return ERROR;
+    e->revents &= e->events;
+    if (e->revents) ready++;
+  }
+  return ready;
+}
+
+// registers a proxy of the running process on pollers, remembering where it went
+void add_poller(ll_t *pollers, node_t **proxies, ll_t **lists, int *k) {
+  node_t *proxy = new_node(procs->running);
+  proxy->code = 1; // attached
+  enqueue(pollers, proxy);
+  proxies[*k] = proxy;
+  lists[(*k)++] = pollers;
+}
+
+int poll(poll_entry_t *fds, int n, int timeout) {
+  node_t *proxies[2 * POLL_MAX]; // each entry may register on an input and an output list
+  ll_t *lists[2 * POLL_MAX];
+  int ready;
+  while ((ready = poll_scan(fds, n)) == 0 && timeout != 0) {
+    int k = 0;
+    for (int i = 0; i < n; i++) {
+      if (fds[i].kind == POLL_PIPE) {
+        if (fds[i].events) add_poller(((pipe_t *) find_pipe(fds[i].id)->data)->pollers, proxies, lists, &k);
+      } else if (fds[i].id >= NUM_TERMINALS) { // either side of a pty
+        if (fds[i].events) add_poller(find_pty(fds[i].id)->in->pollers, proxies, lists, &k);
+      } else {
+        if (fds[i].events & POLL_IN) add_poller(io->in[fds[i].id]->pollers, proxies, lists, &k);
+        if (fds[i].events & POLL_OUT) add_poller(io->out[fds[i].id]->pollers, proxies, lists, &k);
+      }
+    }
+    if (k == 0) return 0; // nothing to wait for
+    procs->running->code = timeout; // ticks left, counted down by the clock
+    block(procs->polling);
+    timeout = procs->running->code;
+    for (int j = 0; j < k; j++) { // deregister from everything that didn't wake us
+      if (proxies[j]->code) remove(lists[j], proxies[j]);
+      kfree(proxies[j]); // not destroy_node(): its data is our own process node
+    }
+  }
+  return ready;
+}
@@ -9,21 +9,44 @@
 #include <ykernel.h>
 #include "linked_list.h"
 #include "scheduling.h"
-
-// circular buffer
-typedef struct buffer {
-  int size;
-  int filled;
-  int head; // first char index
-  int tail; // one after the last char index (everything mod size)
-  char *buffered;
-} buffer_t;
-
+#include "ycustom.h"
+#include "buffer.h"
+
+// page-aligned writes of at least this many bytes move whole frames into the pipe instead of copying
+#define PIPE_FLIP_MIN PAGESIZE
+// the most frames a pipe may hold at once; writes past it fall back to copying
+#define PIPE_FLIP_MAX_PAGES 16
+
+// default size of each terminal's output ring, overridden by the ttyq= boot option
+#define TTY_OUT_RING (4 * TERMINAL_MAX_LINE)
+// default size of each terminal's input ring, overridden by the ttyin= boot option
+#define TTY_IN_RING (4 * TERMINAL_MAX_LINE)
+// the most line boundaries an input ring remembers; past it, new lines join the last one
+#define TTY_IN_LINES 64
+// the biggest ring ttyq=/ttyin= may ask for
+#define TTY_RING_MAX (64 * TERMINAL_MAX_LINE)
+// # of futex wait queues, picked by physical address
+#define FUTEX_BUCKETS 16
+
+// size of each direction of a pseudo-terminal
+#define PTY_RING (2 * TERMINAL_MAX_LINE)
+// blocking writes of at least this many bytes to an idle terminal transmit straight from the writer's frames
+#define TTY_DIRECT_MIN TERMINAL_MAX_LINE
+
+// blocked readers/writers keep what they need in their process node's code:
+// bytes wanted for readers, space needed for writers. Once woken, it's what they were promised
 typedef struct pipe {
   buffer_t *buffer;
   ll_t *readblocked;
   ll_t *writeblocked;
   int unfulfilled; // unfulfilled promises, i.e. things that woke up but in the ready queue
+  int promised_data;  // buffered bytes promised to woken readers
+  int promised_space; // free space promised to woken writers
+  ll_t *pages;    // frames flipped in by writers, all ahead of the buffer's bytes (node code is the pfn)
+  int page_off;   // # of bytes already copied out of the head page
+  int page_bytes; // # of unread bytes in pages
+  ll_t *pollers;  // proxy nodes of processes Poll()-ing us (node data is the process node)
+  pipe_stat_t stat;
 } pipe_t;
 
 typedef struct lock {
@@ -31,113 +54,153 @@ typedef struct lock {
   ll_t *blocked;
   int unfulfilled;
   int cvar;
+  int mode; // LOCK_MESA or LOCK_HANDOFF
+  lock_stat_t stat;
 } lock_t;
 
 typedef struct cvar {
   ll_t *blocked;
+  cvar_stat_t stat;
 } cvar_t;
 
+// readers and writers are only woken once they hold the rwlock, so they never check again
+typedef struct rwlock {
+  node_t *writer; // the process writing, NULL if none
+  ll_t *readers;  // one node per read hold, with the reader's pid as code
+  ll_t *readblocked;
+  ll_t *writeblocked;
+  rwlock_stat_t stat;
+} rwlock_t;
+
+// SemUp hands its unit straight to the head waiter instead of bumping the count
+typedef struct sem {
+  int count;
+  ll_t *blocked;
+  sem_stat_t stat;
+} sem_t;
+
+typedef struct barrier {
+  int n;          // # of processes to wait for
+  ll_t *blocked;  // the ones that arrived, all but the last
+  barrier_stat_t stat;
+} barrier_t;
+
 typedef struct pilocvar {
   int count; // next available id
   ll_t *pipe;
   ll_t *lock;
   ll_t *cvar;
+  ll_t *rwlock;
+  ll_t *sem;
+  ll_t *barrier;
+  ll_t *futex[FUTEX_BUCKETS]; // processes in FutexWait; their node's code is the physical address waited on
+  ll_t *shm;
 } pilocvar_t;
 
+typedef struct shm { // shared memory segment
+  int npages;
+  int *pfns; // its FRAME_SHM frames, each with a reference held by the segment until Reclaim
+} shm_t;
+
 typedef struct ttyio {
-  buffer_t *buffer;
+  buffer_t *buffer; // for output, the ring TtyWrite appends to and transmits drain; for input, received lines
   ll_t *blocked;
+  ll_t *pollers; // proxy nodes of processes Poll()-ing us (node data is the process node)
   int transmitting;
+  int waiters; // output: writers queued for ring space, including a woken one that hasn't run yet
+  int waking; // 1 while the head writer/reader has been woken but hasn't run yet
+  int *lines; // input: unread bytes of each line in buffer, a ring of TTY_IN_LINES from line_head
+  int line_head;
+  int line_count;
+  int direct; // output: 1 while transmitting straight from the frames of the writer at the head
 } ttyio_t;
 
+typedef struct pty { // pseudo-terminal: the slave side is a terminal, the master side drives it
+  ttyio_t *in; // lines the master wrote, for the slave's TtyRead, kept like a terminal's input
+  buffer_t *out; // what the slave TtyWrote, for the master's PtyRead
+  ll_t *out_readers; // masters blocked in PtyRead
+  ll_t *out_writers; // slaves blocked in TtyWrite on a full out
+  int unfulfilled; // out_readers/out_writers woken but not yet run, still about to touch us
+  // Poll()-ers of either side are on in->pollers, woken whenever anything moves either way
+} pty_t;
+
 typedef struct io_control {
   ttyio_t *in[NUM_TERMINALS];
   ttyio_t *out[NUM_TERMINALS];
-  char landing_buffer[TERMINAL_MAX_LINE]; // this is the landing buffer for ttyreceive/transmit
+  pty_t *pty[MAX_PTYS]; // pty id NUM_TERMINALS + i, NULL if free
+  char landing_buffer[TERMINAL_MAX_LINE]; // this is the landing buffer for ttyreceive
+  char transmit_buffer[NUM_TERMINALS][TERMINAL_MAX_LINE]; // the chunk each terminal is transmitting
 } io_control_t;
 
 /******************************* FUNCTION DECLARATIONS *****************************/
 
-/////////////////////// BUFFER
-
-/* Initializes and returns a new buffer pointer
- * Must be free'd later by caller
- *
- * @param size the specified size of the new buffer
- * @return the initialized buffer pointer
- */
-buffer_t *new_buffer(int size);
-
-/* Writes len bytes of the src string to the buffer
- * If the avalailable space remaining in the buffer is less than len, 
- * only the available amount is written.
- *
- * @param buffer the buffer pointer to write to
- * @param src the source sring to write into buffer
- * @param len the number of bytes to write
- * @return the number of bytes ACTUALLy written
- */
-int write_buffer(buffer_t *buffer, char *src, int len);
-
-/* Writes len bytes of the src string to the buffer
- * If the avalailable space remaining in the buffer is less than len, 
- * only the available amount is written.
- *
- * @param buffer the buffer pointer to read from
- * @param dst the char* destination to store the read bytes into
- * @param len the number of bytes to read
- * @return the number of bytes ACTUALLY read 
- */
-int read_buffer(buffer_t *buffer, char *dst, int len);
-
-/* Resets the buffer as if new
- *
- * @param buffer the buffer to reset
- */
-void reset_buffer(buffer_t *buffer);
-
-/* Destroys/frees the buffer and its contents
- *
- * @param buffer the buffer to destroy
- */
-void destroy_buffer(buffer_t *buffer);
-
 //////////////// TTYIO
 
 /* Initializes and returns a new terminal pointer
- * with a max buffer size = TERMINAL_MAX_LINE
+ * with a max buffer size = size
  * Must be free'd later by caller
  *
+ * @param size the buffer size
  * @return the initialized ttyio_t pointer
  */
-ttyio_t *new_ttyio(void);
+ttyio_t *new_ttyio(int size);
 
 /* Initializes and returns a new IO control pointer
  * with NUM_TERMINALS of in/out terminals
  * Must be free'd later by caller
  *
+ * @param out_ring the size of each terminal's output ring
+ * @param in_ring the size of each terminal's input ring
  * @return the initialized io_control_t pointer
  */
-io_control_t *io_control_init(void);
+io_control_t *io_control_init(int out_ring, int in_ring);
 
 /* Per the Yalnix Manual:
  * - Write the contents of the char* src to the terminal tty id.
- * The length written in bytes is given by len. The calling process is
- * blocked until all characters from the buffer have been written on the terminal. 
+ * The length written in bytes is given by len.
+ *
+ * Unlike the manual, the bytes are appended to the terminal's output ring
+ * and the call returns as soon as they are all in it, not once transmitted.
+ * Blocks only while the ring is full; writers waiting for space are served FIFO,
+ * and a write that fits in the ring at once never interleaves with others.
+ *
+ * A blocking write of at least TTY_DIRECT_MIN bytes from user memory to an idle
+ * terminal skips the ring: it is transmitted a chunk at a time straight out of
+ * the writer's frames, mapped into the terminal's kernel window, and the writer
+ * stays blocked until the last chunk is out, as in the manual.
  *
  * Leverages hardware function TtyTransmit to perform actual terminal writing. 
  * write_tty() is a wrapper called by the syscall KernelTtyWrite()
  *
+ * With IO_NONBLOCK, appends what fits and returns its length right away,
+ * WOULD_BLOCK if nothing fits
+ *
  * @param tty_id the terminal id
  * @param src the source string to write to the terminal
  * @param len the # of bytes to write
- * @return the # of bytes written on success
+ * @param flags 0 or IO_NONBLOCK
+ * @return the # of bytes written on success, WOULD_BLOCK
+ */
+int write_tty(int tty_id, char *src, int len, int flags);
+
+/* Writes the n segments of iov to the terminal, in order, holding it throughout
+ * so no other writer's output lands in between. Needs no gathered copy,
+ * and big segments go out zero-copy when the terminal is idle
+ *
+ * With IO_NONBLOCK, writes segments until one doesn't fit completely
+ *
+ * @param tty_id the terminal id
+ * @param iov the (already checked) kernel copy of the segments to write
+ * @param n the # of segments
+ * @param flags 0 or IO_NONBLOCK
+ * @return the # of bytes written, WOULD_BLOCK
  */
-int write_tty(int tty_id, char *src, int len);
+int writev_tty(int tty_id, io_vec_t *iov, int n, int flags);
 
 /* Alerts the specified terminal (by tty_id) that the last TtyTransmit
- * has finished: resets the terminal's out buffer and unblocks whoever
- * called that TtyTransmit
+ * has finished: starts transmitting the next chunk of the output ring,
+ * up to TERMINAL_MAX_LINE bytes however many writes they came from,
+ * and wakes the next writer waiting for ring space
  *
  * write_alert() is called by trapfunct TrapTtyTransmit
  * 
@@ -157,16 +220,34 @@ void write_alert(int tty_id);
  * read_tty() is a wrapper called by the syscall KernelTtyRead()
  * Assumes len > 0
  *
+ * Here, "unread bytes waiting" means those left of the oldest received line, so a read
+ * never spans lines. Blocked readers are woken one at a time in FIFO order, each
+ * waking the next if lines remain once it has read
+ *
+ * With IO_NONBLOCK, returns WOULD_BLOCK instead of blocking for input
+ *
  * @param tty_id the terminal id
  * @param dst the destination to copy read bytes to
  * @param len the len of bytes desired to read
- * @return the actual # of bytes copied into dst on success
+ * @param flags 0 or IO_NONBLOCK
+ * @return the actual # of bytes copied into dst on success, WOULD_BLOCK
+ */
+int read_tty(int tty_id, char *dst, int len, int flags);
+
+/* read_tty() for any terminal's input, real or pseudo: see read_tty()
+ *
+ * @param in the terminal input to read
+ * @param dst the destination to copy read bytes to
+ * @param len the len of bytes desired to read
+ * @param flags 0 or IO_NONBLOCK
+ * @return the actual # of bytes copied into dst on success, WOULD_BLOCK
  */
-int read_tty(int tty_id, char *dst, int len);
+int read_lines(ttyio_t *in, char *dst, int len, int flags);
 
 /* Receives the new line of input using the TtyReceive hardware function,
- * and stores it into the input buffer of the specified terminal for
- * some process to eventually TtyRead()
+ * and stores it into the input ring of the specified terminal for
+ * some process to eventually TtyRead(), waking the first blocked reader.
+ * Whatever doesn't fit in the ring is dropped
  *
  * receive() is called by trapfunct TrapTtyReceive
  *
@@ -174,6 +255,92 @@ int read_tty(int tty_id, char *dst, int len);
  */
 void receive(int tty_id);
 
+//////////////// PTY
+
+/* Creates a new pseudo-terminal
+ *
+ * @return its id, ERROR if all MAX_PTYS are taken
+ */
+int new_pty(void);
+
+/* Returns the pseudo-terminal with the given id
+ *
+ * @param pty_id the id
+ * @return the pty, NULL if none
+ */
+pty_t *find_pty(int pty_id);
+
+/* Frees the pseudo-terminal with the given id
+ *
+ * @param pty_id the id
+ * @return 0 on success, ERROR if none or anyone is blocked on it or woken and yet to run
+ */
+int destroy_pty(int pty_id);
+
+/* Master side: reads what the slave wrote. Blocks (unless IO_NONBLOCK)
+ * until there's something, like read_pipe()
+ *
+ * @param pty the pseudo-terminal
+ * @param dst where to copy to
+ * @param len the max # of bytes to read
+ * @param flags 0 or IO_NONBLOCK
+ * @return the # of bytes read, WOULD_BLOCK
+ */
+int read_pty(pty_t *pty, char *dst, int len, int flags);
+
+/* Master side: types src into the slave's input, as if received a line
+ * at a time, splitting at newlines (and every TERMINAL_MAX_LINE bytes, like
+ * TtyReceive). Never blocks: like a real terminal, a line that doesn't fit
+ * is not taken, so lines are never split across calls
+ *
+ * @param pty the pseudo-terminal
+ * @param src what to type
+ * @param len the # of bytes
+ * @return the # of bytes taken
+ */
+int write_pty(pty_t *pty, char *src, int len);
+
+/* Slave side: write_tty() to a pseudo-terminal. Blocks (unless IO_NONBLOCK)
+ * while the master hasn't read enough for all of src to fit
+ *
+ * @param pty the pseudo-terminal
+ * @param src the bytes to write
+ * @param len the # of bytes
+ * @param flags 0 or IO_NONBLOCK
+ * @return the # of bytes written, WOULD_BLOCK
+ */
+int write_pty_slave(pty_t *pty, char *src, int len, int flags);
+
+/* Slave side: read_tty() from a pseudo-terminal, a line at a time
+ *
+ * @param pty the pseudo-terminal
+ * @param dst where to copy to
+ * @param len the max # of bytes to read
+ * @param flags 0 or IO_NONBLOCK
+ * @return the # of bytes read, WOULD_BLOCK
+ */
+int read_pty_slave(pty_t *pty, char *dst, int len, int flags);
+
+/////////////// FUTEX
+
+/* Blocks the running process on the futex at physical address paddr,
+ * unless the word at addr (its user address) no longer holds val
+ *
+ * @param paddr the futex's physical address, its key
+ * @param addr the futex word, in the running process
+ * @param val the value the caller last saw there
+ * @return 0 once woken, FUTEX_CHANGED if *addr != val
+ */
+int futex_wait(unsigned int paddr, int *addr, int val);
+
+/* Wakes up to n processes blocked on the futex at physical address paddr, oldest first
+ *
+ * @param paddr the futex's physical address
+ * @param n the most to wake
+ * @return the # woken
+ */
+int futex_wake(unsigned int paddr, int n);
+
 /////////////// PIPE
 
 /* Returns a new pipe node pointer containing initialized pipe data 
@@ -181,19 +348,55 @@ void receive(int tty_id);
  * on the global pilocvar bookkeeper
  *
  * @param id the desired pipe id
+ * @param cap the max # of bytes the pipe may buffer (PIPE_BUFFER_LEN by default)
  * @return the initialized pipe node pointer
  */
-node_t *new_pipe(int id);
+node_t *new_pipe(int id, int cap);
+
+/* Sets the max # of bytes the given pipe may buffer. Wakes blocked writers
+ * if there's now more room for them
+ *
+ * @param pipe_n the pipe node
+ * @param cap the new capacity, 1 to PIPE_MAX_CAPACITY
+ * @return 0 on success, ERROR if cap is out of range or below what's buffered
+ */
+int set_pipe_cap(node_t *pipe_n, int cap);
 
 /* Writes len bytes starting at src to the specified pipe,
  * returning as soon as all len bytes have been written
+ * With IO_NONBLOCK, writes only what fits right now instead of blocking
  *
  * @param pipe_n the pipe node to write to
  * @param src the source string to start writing from
  * @param len the # of bytes to write
- * @return the total # of bytes written to the pipe
+ * @param flags 0 or IO_NONBLOCK
+ * @return the total # of bytes written to the pipe, WOULD_BLOCK if IO_NONBLOCK and none fit
+ */
+int write_pipe(node_t *pipe_n, char *src, int len, int flags);
+
+/* Writes the n segments of iov to the specified pipe, in order. If they fit in
+ * the pipe's capacity, waits until they all fit at once, so no other writer's
+ * bytes land in between. Larger writes go segment by segment, like write_pipe()
+ *
+ * @param pipe_n the pipe node to write to
+ * @param iov the (already checked) kernel copy of the segments to write
+ * @param n the # of segments
+ * @param flags 0 or IO_NONBLOCK
+ * @return the total # of bytes written to the pipe, WOULD_BLOCK if IO_NONBLOCK and they don't fit
+ */
+int writev_pipe(node_t *pipe_n, io_vec_t *iov, int n, int flags);
+
+/* Reads from the specified pipe into the n segments of iov, in order.
+ * Blocks (unless IO_NONBLOCK) only until the first bytes are available,
+ * like read_pipe(), then fills as many segments as the pipe has data for
+ *
+ * @param pipe_n the pipe node to read from
+ * @param iov the (already checked) kernel copy of the segments to fill
+ * @param n the # of segments
+ * @param flags 0 or IO_NONBLOCK
+ * @return the total # of bytes read, WOULD_BLOCK
  */
-int write_pipe(node_t *pipe_n, char *src, int len);
+int readv_pipe(node_t *pipe_n, io_vec_t *iov, int n, int flags);
 
 /* Reads len consecutifve bytes from the specified pipe
  * into the destination dst, following the standard semantics:
@@ -202,12 +405,15 @@ int write_pipe(node_t *pipe_n, char *src, int len);
  * – If the pipe has plen > len unread bytes, give the first len bytes to caller and return. 
  *                                            Retain the unread plen − len bytes in the pipe.
  *
+ * With IO_NONBLOCK, returns WOULD_BLOCK instead of blocking on an empty pipe
+ *
  * @param pipe_n the pipe node to read from
  * @param dst the destination buffer to store the read bytes
  * @param len the len of desired bytes to read
- * @return the actual # of bytes read from the pipe
+ * @param flags 0 or IO_NONBLOCK
+ * @return the actual # of bytes read from the pipe, WOULD_BLOCK
  */
-int read_pipe(node_t *pipe_n, char *dst, int len);
+int read_pipe(node_t *pipe_n, char *dst, int len, int flags);
 
 /* Destroys/frees the pipe and its contents
  * and removes it from the global pilocvar
@@ -229,16 +435,19 @@ int destroy_pipe(node_t *pipe_n);
 node_t *new_lock(int id);
 
 /* Acquires the specified lock. If there is another current 
- * owner of the lock, the calling process blocks, mesa-style
- * When this function returns, the calling process will
+ * owner of the lock, the calling process blocks, mesa-style,
+ * unless the lock is in LOCK_HANDOFF mode and release() hands it over.
+ * When this function returns 0, the calling process will
  * assuredly have acquired the lock.
  *
  * @param lock_n the lock node to acquire
- * @return 0
+ * @param timeout the most clock-ticks to wait, WAIT_FOREVER for no limit
+ * @return 0 once acquired, TIMEDOUT if it wasn't within timeout ticks
  */
-int acquire(node_t *lock_n);
+int acquire(node_t *lock_n, int timeout);
 
-/* Releases the specified lock.
+/* Releases the specified lock, waking the head waiter. In LOCK_HANDOFF
+ * mode, that waiter becomes the owner right away, so no one can barge in
  *
  * @param lock_n the lock node to release
  * @return 0 on success, ERROR otherwise
@@ -264,13 +473,18 @@ int destroy_lock(node_t *lock_n);
  */
 node_t *new_cvar(int id);
 
-/* Signals the condition variable specified by cvar_n node
+/* Signals the condition variable specified by cvar_n node.
+ * The head waiter is moved straight to the lock it waits with (wait morphing):
+ * if the lock is free, it becomes the owner and is woken, otherwise it joins
+ * the lock's queue and is woken by release(), never just to block again
  *
  * @param cvar_n the specified cvar node to signal
  */
 void signal_cvar(node_t *cvar_n);
 
-/* Broadcasts the condition variable specified by cvar_n node
+/* Broadcasts the condition variable specified by cvar_n node.
+ * Like signal_cvar(), for every waiter: at most one is woken, the rest
+ * wait on the lock
  *
  * @param cvar_n the specified cvar node to broadcast
  */
@@ -278,11 +492,16 @@ void broadcast(node_t *cvar_n);
 
 /* Releases the specified lock and waits on the specified condition variable 
  * When the lock is finally acquired, the call returns to userland.
+ * Remembers the lock in the pcb so signal_cvar()/broadcast() can requeue us on it
+ * With a timeout, gives up waiting for a signal after that many clock-ticks,
+ * but still reacquires the lock before returning
  *
  * @param cvar_n the specified cvar node to wait on
  * @param lock_n the specified lock node to wait with
+ * @param timeout the most clock-ticks to wait for a signal, WAIT_FOREVER for no limit
+ * @return 0 if signaled, TIMEDOUT otherwise
  */
-void wait_cvar(node_t *cvar_n, node_t *lock_n);
+int wait_cvar(node_t *cvar_n, node_t *lock_n, int timeout);
 
 /* Destroys/frees the specified cvar and removes it from
  * the cvar list in the global pilocvar
@@ -292,6 +511,132 @@ void wait_cvar(node_t *cvar_n, node_t *lock_n);
  */
 int destroy_cvar(node_t *cvar_n);
 
+////////////// RWLOCK
+
+/* Returns a new reader-writer lock node with the specified id,
+ * added to the rwlock list on the global pilocvar bookkeeper
+ *
+ * @param id the desired rwlock id
+ * @return the initialized rwlock node pointer
+ */
+node_t *new_rwlock(int id);
+
+/* Acquires the rwlock for reading, alongside any other readers.
+ * Writer-preferring: blocks while a writer holds it or is waiting for it
+ *
+ * @param rw_n the rwlock node
+ */
+void read_acquire(node_t *rw_n);
+
+/* Acquires the rwlock for writing, blocking until
+ * there are no readers and no other writer
+ *
+ * @param rw_n the rwlock node
+ */
+void write_acquire(node_t *rw_n);
+
+/* Releases the running process' read or write hold on the rwlock.
+ * A writer's release lets in every waiting reader at once, or the next
+ * writer if there are none; the last reader's release lets in the next writer
+ *
+ * @param rw_n the rwlock node
+ * @return 0 on success, ERROR if the process doesn't hold it
+ */
+int rw_release(node_t *rw_n);
+
+/* Destroys/frees the specified rwlock and removes it from
+ * the rwlock list in the global pilocvar
+ *
+ * @param rw_n the rwlock node to destroy
+ * @return 0 on success, ERROR if it's held or waited on
+ */
+int destroy_rwlock(node_t *rw_n);
+
+////////////// SEM
+
+/* Returns a new semaphore node with the specified id and count,
+ * added to the sem list on the global pilocvar bookkeeper
+ *
+ * @param id the desired sem id
+ * @param count the initial count
+ * @return the initialized sem node pointer
+ */
+node_t *new_sem(int id, int count);
+
+/* Takes a unit from the semaphore, blocking while the count is 0
+ *
+ * @param sem_n the sem node
+ */
+void sem_down(node_t *sem_n);
+
+/* Gives a unit to the semaphore's head waiter, or adds it to the count if none
+ *
+ * @param sem_n the sem node
+ */
+void sem_up(node_t *sem_n);
+
+/* Destroys/frees the specified sem and removes it from
+ * the sem list in the global pilocvar
+ *
+ * @param sem_n the sem node to destroy
+ * @return 0 on success, ERROR if it's waited on
+ */
+int destroy_sem(node_t *sem_n);
+
+////////////// BARRIER
+
+/* Returns a new barrier node with the specified id, for n processes,
+ * added to the barrier list on the global pilocvar bookkeeper
+ *
+ * @param id the desired barrier id
+ * @param n the # of processes each round waits for
+ * @return the initialized barrier node pointer
+ */
+node_t *new_barrier(int id, int n);
+
+/* Blocks until n processes are waiting on the barrier. The last to arrive
+ * splices all the others onto the ready queue at once and carries on, and the
+ * barrier is ready for the next round
+ *
+ * @param barrier_n the barrier node
+ */
+void barrier_wait(node_t *barrier_n);
+
+/* Destroys/frees the specified barrier and removes it from
+ * the barrier list in the global pilocvar
+ *
+ * @param barrier_n the barrier node to destroy
+ * @return 0 on success, ERROR if it's waited on
+ */
+int destroy_barrier(node_t *barrier_n);
+
+////////////// SHM
+
+/* Creates a new shared memory segment of npages zeroed frames and
+ * adds it to the shm list of the global pilocvar
+ *
+ * @param id the id of the segment
+ * @param npages the # of pages
+ * @return the new segment node, NULL if not enough frames
+ */
+node_t *new_shm(int id, int npages);
+
+/* Destroys the specified segment and removes it from the shm list.
+ * Only the segment's references to its frames go: processes still
+ * attached keep them until they detach, exec or exit
+ *
+ * @param shm_n the segment node to destroy
+ * @return 0
+ */
+int destroy_shm(node_t *shm_n);
+
+/* finds the shared memory segment specified by id in the global pilocvar shm list
+ *
+ * @param id the specified id of the segment to find
+ * @return the found segment node, NULL if not found
+ */
+node_t *find_shm(int id);
+
 ////////////// GENERAL
 
 /* Initializes and returns a new pilocvar_t pointer
@@ -327,4 +672,70 @@ node_t *find_lock(int id);
  */
 node_t *find_cvar(int id);
 
+/* finds the rwlock specified by id in the global pilocvar rwlock list
+ *
+ * @param id the specified id of the rwlock to find
+ * @return the found rwlock node, NULL if not found
+ */
+node_t *find_rwlock(int id);
+
+/* finds the sem specified by id in the global pilocvar sem list
+ *
+ * @param id the specified id of the sem to find
+ * @return the found sem node, NULL if not found
+ */
+node_t *find_sem(int id);
+
+/* finds the barrier specified by id in the global pilocvar barrier list
+ *
+ * @param id the specified id of the barrier to find
+ * @return the found barrier node, NULL if not found
+ */
+node_t *find_barrier(int id);
+
+/* Fills in the statistics of the pipe/lock/cvar specified by id
+ *
+ * @param id the id of the pipe/lock/cvar
+ * @param stat the ipc_stat_t to fill in
+ * @return 0 on success, ERROR if no pipe/lock/cvar found with specified id
+ */
+int stat_ipc(int id, ipc_stat_t *stat);
+
+/* Fills in the statistics of every pipe, lock, and cvar,
+ * up to max of them, in the order pipes, locks, cvars
+ *
+ * @param stats the array of ipc_stat_t to fill in
+ * @param max the max # of entries to fill in
+ * @return the total # of pipes/locks/cvars alive (may be > max)
+ */
+int list_ipc(ipc_stat_t *stats, int max);
+
+//////////////// Poll
+
+/* Wakes every process Poll()-ing on the given pollers ll, detaching them from it.
+ * Called whenever a pipe or terminal might have become ready
+ *
+ * @param pollers the pollers ll of a pipe or terminal
+ */
+void wake_pollers(ll_t *pollers);
+
+/* Fills in the revents of each of the n entries with which of its events are ready
+ *
+ * @param fds the poll entries
+ * @param n the # of entries
+ * @return the # of entries with some event ready, ERROR if an entry names no pipe/terminal/pty
+ */
+int poll_scan(poll_entry_t *fds, int n);
+
+/* Blocks until any of the n entries has one of its events ready, or timeout
+ * clock-ticks pass. While blocked, the process is registered on every
+ * entry's pipe/terminal, and it deregisters from all of them when woken
+ *
+ * @param fds the poll entries, revents filled in on return
+ * @param n the # of entries
+ * @param timeout max # of clock-ticks to block, 0 to not block, POLL_FOREVER to not time out
+ * @return the # of ready entries, 0 on timeout, ERROR if an entry names no pipe/terminal
+ */
+int poll(poll_entry_t *fds, int n, int timeout);
+
 #endif //__PILOCVARIO_H
@@ -14,24 +14,39 @@ node_t *get_parent(node_t *proc) {
 }
 
 node_t *process_init(void) {
-  pcb_t *new_pcb = malloc(sizeof(pcb_t));
+  pcb_t *new_pcb = kmalloc(sizeof(pcb_t), KH_PCB);
   new_pcb->parent = NULL;
   new_pcb->a_children = new_ll();
   new_pcb->d_children = new_ll();
+  new_pcb->waitq = new_ll();
+  new_pcb->waiting_for = WAIT_ANY;
+  new_pcb->cvar_lock = NULL;
+  new_pcb->timer = NULL;
+  new_pcb->timed_queue = NULL;
+  new_pcb->timed_out = 0;
+  memset(&new_pcb->wait, 0, sizeof(io_wait_t));
   new_pcb->userpt = new_user_pt();
-  new_pcb->kstack = malloc(sizeof(kernel_stack_pt_t));
+  new_pcb->kstack = kmalloc(sizeof(kernel_stack_pt_t), KH_KSTACK_PT);
+  for (int vpn = BASE_PAGE_KSTACK; vpn < LIM_PAGE_KSTACK; vpn++) // no kstack frames yet
+    set_pte(&new_pcb->kstack->pt[vpn - BASE_PAGE_KSTACK], 0, NONE, NONE);
   new_pcb->pid = helper_new_pid(new_pcb->userpt->pt);
+  new_pcb->userpt->pid = new_pcb->pid;
   return new_node((void *) new_pcb);
 }
 
+void process_adopt(node_t *parent, node_t *child) {
+  pcb_t *child_pcb = child->data, *parent_pcb = parent->data;
+  node_t *child_copy = new_node((void *) child_pcb);
+  enqueue(parent_pcb->a_children, child_copy);
+  child_pcb->parent = parent;
+}
+
 node_t *process_copy(node_t* parent) {
   node_t *child_node = process_init();
   pcb_t *child = child_node->data, *parent_pcb = parent->data;
-  node_t *child_copy = new_node((void *) child);
-  enqueue(parent_pcb->a_children, child_copy);
-  child->parent = parent;
+  process_adopt(parent, child_node);
   child->uc = parent_pcb->uc;
-  copy_user_mem(parent_pcb->userpt, child->userpt);
+  copy_user_mem(parent_pcb->userpt, child->userpt, child->pid);
   return child_node;
 }
 
@@ -46,23 +61,25 @@ void process_terminate(node_t *proc, int rc) { // return code
   node_t *last = NULL;
   for (node_t *curr = p->a_children->head; curr != NULL; curr = curr->next) {
     ((pcb_t *) curr->data)->parent = NULL;
-    free(last);
+    kfree(last);
     last = curr;
   }
-  free(last);
-  free(p->a_children);
+  kfree(last);
+  kfree(p->a_children);
   p->a_children = NULL;
   // destroy defunct children
   for (node_t* curr = p->d_children->head; curr != NULL; curr = curr->next)
     process_destroy(curr);
-  free(p->d_children);
+  kfree(p->d_children);
   p->d_children = NULL;
+  kfree(p->waitq);
+  p->waitq = NULL;
 }
 
 void process_destroy(node_t *proc) {
   pcb_t *p = proc->data;
   destroy_kstack(p->kstack);
-  free(p->kstack);
-  free(p->userpt);
+  kfree(p->kstack);
+  kfree(p->userpt);
   destroy_node(proc);
 }
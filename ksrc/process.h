@@ -10,12 +10,26 @@
 #include "linked_list.h"
 #include "memory.h"
 
+// a blocked process' pending I/O request, so another process can complete it directly
+typedef struct io_wait {
+  void *buf; // user buffer, in the blocked process' region 1
+  int len;
+  int done;  // # of bytes completed by someone else while blocked
+} io_wait_t;
+
 // the payload of a pcb
 typedef struct pcb {
   int pid;
   node_t *parent;    // quick parent-tracking
   ll_t *a_children;  // linked-list of alive children, different nodes but same pcbs
   ll_t *d_children;  // linked-list of defunct children
+  ll_t *waitq;       // our own wait channel: holds just us while WaitPid()-ing
+  int waiting_for;   // the child pid we're waiting on, or WAIT_ANY
+  io_wait_t wait;    // our pending read while blocked on a pipe
+  node_t *cvar_lock; // the lock to reacquire while blocked in CvarWait
+  node_t *timer;     // our proxy on the proc table's timers while in a timed wait, NULL otherwise
+  ll_t *timed_queue; // the queue that timed wait blocks on
+  int timed_out;     // 1 if the timer, not a wakeup, ended the last timed wait
   user_pt_t *userpt; // user page table
   kernel_stack_pt_t *kstack; // copy of kernel stack page table
   UserContext uc;    
@@ -47,6 +61,13 @@ node_t *get_parent(node_t *proc);
  */
 node_t *process_init(void);
 
+/* Makes the given child process node an alive child of the given parent
+ *
+ * @param parent the parent process node
+ * @param child the child process node
+ */
+void process_adopt(node_t *parent, node_t *child);
+
 /* Copies the given process node (prob parent), along with
  * its memory content (user and kernel stack). Does NOT copy 
  * kernel context because whose timing is critical
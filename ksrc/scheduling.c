@@ -12,12 +12,14 @@ extern proc_table_t *procs;
 extern node_t *idle_node;
 
 proc_table_t *proc_table_init(void) {
-  proc_table_t *p = malloc(sizeof(proc_table_t));
+  proc_table_t *p = kmalloc(sizeof(proc_table_t), KH_PCB);
   p->running = NULL;
-  p->waiting = new_ll();
   p->ready = new_ll();
   p->delayed = new_ll();
   p->orphans = new_ll();
+  p->polling = new_ll();
+  p->timers = new_ll();
+  p->ticks = 0;
   return p;
 }
 
@@ -60,8 +62,7 @@ void unblock_head(ll_t *blocked) {
 }
 
 void unblock_all(ll_t *blocked) {
-  while (!is_empty(blocked))
-    ready(dequeue(blocked));
+  splice(procs->ready, blocked);
 }
 
 void block(ll_t* block_list) { 
@@ -74,13 +75,16 @@ void h_block(ll_t* block_list) {
   run_next_ready();
 }
 
-void block_wait(void) { 
-  block(procs->waiting);
+void block_wait(int pid) {
+  pcb_t *p = procs->running->data;
+  p->waiting_for = pid;
+  block(p->waitq);
 }
 
-void check_wait(node_t* parent) {
-  node_t *curr;
-  if (has_member(procs->waiting, parent)) unblock(procs->waiting, parent);
+void check_wait(node_t* parent, node_t *child) {
+  pcb_t *p = parent->data;
+  if (is_empty(p->waitq)) return; // not waiting
+  if (p->waiting_for == WAIT_ANY || p->waiting_for == get_pid(child)) unblock_head(p->waitq);
 }
 
 void block_delay(int delay) { 
@@ -89,36 +93,78 @@ void block_delay(int delay) {
 }
 
 void check_delay(void) {
-  node_t *curr;
-  for (curr = procs->delayed->head; curr != NULL; curr = curr->next) {
+  node_t *curr, *next;
+  for (curr = procs->delayed->head; curr != NULL; curr = next) {
+    next = curr->next; // unblocking moves curr onto the ready queue
     if (--(curr->code) == 0) unblock(procs->delayed, curr);
   }
 }
 
-void graveyard(void) { 
-  node_t* parent = get_parent(procs->running);
-  if (parent != NULL) { // put onto parent's defunct children queue
-    enqueue(((pcb_t*) parent->data)->d_children, procs->running);
-    check_wait(parent); // unblock if parent was waiting                                           
-    parent = NULL; // NULL parent for future errant access
+void check_poll(void) {
+  node_t *curr, *next;
+  for (curr = procs->polling->head; curr != NULL; curr = next) {
+    next = curr->next;
+    if (curr->code > 0 && --(curr->code) == 0) unblock(procs->polling, curr);
   }
-  else // add to proc table's orphan list to be reaped
-    enqueue(procs->orphans, procs->running);    
-  run_next_ready();
 }
 
-void defunct_blocked(ll_t* blocked, node_t *proc) { 
-  remove(blocked, proc);
+void arm_timer(int ticks, ll_t *queue) {
+  pcb_t *p = procs->running->data;
+  p->timer = new_node(procs->running);
+  p->timer->code = ticks;
+  p->timed_queue = queue;
+  p->timed_out = 0;
+  enqueue(procs->timers, p->timer);
+}
+
+int disarm_timer(node_t *proc) {
+  pcb_t *p = proc->data;
+  if (p->timer == NULL) return 0;
+  int left = p->timer->code;
+  kfree(remove(procs->timers, p->timer)); // not destroy_node(): its data is the process node
+  p->timer = NULL;
+  return left;
+}
+
+void check_timers(void) {
+  node_t *curr, *next;
+  for (curr = procs->timers->head; curr != NULL; curr = next) {
+    next = curr->next;
+    if (--(curr->code) > 0) continue;
+    node_t *proc = curr->data;
+    pcb_t *p = proc->data;
+    disarm_timer(proc);
+    if (has_member(p->timed_queue, proc)) { // still waiting
+      p->timed_out = 1;
+      unblock(p->timed_queue, proc);
+    }
+  }
+}
+
+void bury(node_t *proc) {
   node_t* parent = get_parent(proc);
-  if (parent != NULL) {// put onto parent's defunct children queue
-    enqueue(((pcb_t*) parent->data)->d_children, proc);
-    check_wait(parent);
-    parent = NULL;
+  if (parent != NULL) { // move from parent's alive children to defunct children
+    pcb_t *parent_pcb = parent->data;
+    node_t *copy = find_data(parent_pcb->a_children, proc->data);
+    if (copy != NULL) kfree(remove(parent_pcb->a_children, copy)); // only the copy node, not our pcb
+    enqueue(parent_pcb->d_children, proc);
+    check_wait(parent, proc); // unblock if parent was waiting on us
+    ((pcb_t*) proc->data)->parent = NULL; // NULL parent for future errant access
   }
   else // add to proc table's orphan list to be reaped
     enqueue(procs->orphans, proc);
 }
 
+void graveyard(void) { 
+  bury(procs->running);
+  run_next_ready();
+}
+
+void defunct_blocked(ll_t* blocked, node_t *proc) { 
+  remove(blocked, proc);
+  bury(proc);
+}
+
 void reap_orphans(void) { 
   // remove and destroy all orphans
   while (!is_empty(procs->orphans))
@@ -15,9 +15,11 @@
 typedef struct proc_table {
   node_t *running;  // the current running process (as node)
   ll_t *ready;      // a linked-list queue of ready process nodes
-  ll_t *waiting;    // a linked-list of blocked processes (specificity unneeded, unlike 'delayed' below)
   ll_t *delayed;    // a linked-list of delaying process nodes (via Delay syscall)
   ll_t *orphans;    // a linked-list of back-logged DEAD orphans to destroy periodically
+  ll_t *polling;    // a linked-list of Poll()-ing process nodes, code is ticks left (POLL_FOREVER if none)
+  ll_t *timers;     // proxy nodes of processes in timed lock/cvar waits: data is the process node, code is ticks left
+  int ticks;        // # of clock-ticks since boot
 } proc_table_t;
 
 /**************************** FUNCTION DECLARATIONS ***************************/
@@ -85,7 +87,7 @@ void unblock(ll_t* blocked, node_t *proc);
 void unblock_head(ll_t *blocked);
 
 /* Unblock all process nodes on the given blocked ll,
- * enqueueing them to the ready queue.
+ * splicing them onto the ready queue in one go.
  * The resulting blocked ll will be empty when returning 
  *
  * @param blocked the blocked ll to unblock all
@@ -106,16 +108,21 @@ void block(ll_t* block_list);
  */
 void h_block(ll_t* block_list);
 
-/* Wrapper that calls block(), with param block_list = waiting ll. */
-void block_wait(void);
+/* Blocks the current process on its own wait channel until the child
+ * with the given pid (or any child if WAIT_ANY) terminates
+ *
+ * @param pid the child pid to wait for, or WAIT_ANY
+ */
+void block_wait(int pid);
 
-/* Checks if the given parent node was Wait()-ing for a child to terminate.
- * Unblocks the parent from the waiting ll if so.
+/* Checks if the given parent node was WaitPid()-ing for the given child,
+ * or any child, to terminate. Unblocks the parent from its wait channel if so.
  * Called when a child exits
  *
  * @param parent the parent to check if waiting
+ * @param child the terminated child process node
  */
-void check_wait(node_t* parent);
+void check_wait(node_t* parent, node_t *child);
 
 /* Wrapper that calls block(), with param blcok_list = delayed ll.
  * Also sets the current process node's code value to the given delay
@@ -130,9 +137,44 @@ void block_delay(int delay);
  */
 void check_delay(void);
 
+/* Starts a timer for the running process, which is about to block on queue:
+ * if it's still there after ticks clock-ticks, check_timers() takes it off
+ * and readies it with its pcb's timed_out set
+ *
+ * @param ticks the # of clock-ticks to wait at most
+ * @param queue the blocked ll the process is about to join
+ */
+void arm_timer(int ticks, ll_t *queue);
+
+/* Stops the given process' timer, if it has one
+ *
+ * @param proc the process node
+ * @return the # of clock-ticks it had left, 0 if none
+ */
+int disarm_timer(node_t *proc);
+
+/* Iterates through the timers, decrementing each one's ticks left. Those that
+ * reach 0 take their process off its queue and ready it, unless something
+ * else woke it first
+ */
+void check_timers(void);
+
+/* Moves the given terminated process from its parent's alive children
+ * to its defunct children, and wakes the parent if it was waiting on it.
+ * If it has no parent, it is added to the proc table's DEAD orphan ll instead
+ *
+ * @param proc the terminated process node
+ */
+void bury(node_t *proc);
+
+/* Iterates through each node in the polling ll, decrementing
+ * each node's timeout, unblocking those that reach 0
+ */
+void check_poll(void);
+
 /* Adds the current process to the graveyard, and Kswitches to the next ready
  * 1. If the proc has a parent:
- *       proc is added to parent's ll of defunct children
+ *       proc is moved from parent's ll of alive children to defunct children
  *       and check_wait()'s if its parent was waiting for their death
  * 2. If no parent:
  *       The proc is added to the proc table's DEAD orphan ll, to be destroyed later
@@ -39,6 +39,46 @@ int KernelExec (char *filename, char **argvec) {
   return code; // error
 }
 
+int KernelSpawn (char *filename, char **argvec) {
+  node_t *parent = procs->running;
+  user_pt_t *curr_pt = ((pcb_t*) parent->data)->userpt;
+  if (!check_string(filename, curr_pt) || !check_args(argvec, curr_pt)) return ERROR;
+  if (no_kernel_memory(NUM_KSTACK_PAGES + 1)) return ERROR;
+  TracePrintf(1, "Process %d Spawn-ing program %s\n", get_pid(parent), filename);
+
+  // the args live in our region 1, which is swapped out while loading
+  char *name_arg[2] = {filename, NULL};
+  char **kname = dup_args(name_arg), **kargs = dup_args(argvec);
+  if (kname == NULL || kargs == NULL) {
+    kfree(kname);
+    kfree(kargs);
+    return ERROR;
+  }
+
+  node_t *child_node = process_init();
+  pcb_t *child = child_node->data;
+  child->uc = ((pcb_t*) parent->data)->uc;
+  WriteRegister(REG_PTBR1, (unsigned int) child->userpt->pt); // load into the child's region 1
+  WriteRegister(REG_TLB_FLUSH, TLB_FLUSH_1);
+  int code = LoadProgram(kname[0], kargs, child);
+  WriteRegister(REG_PTBR1, (unsigned int) curr_pt->pt); // and back to ours
+  WriteRegister(REG_TLB_FLUSH, TLB_FLUSH_1);
+  kfree(kname);
+  kfree(kargs);
+
+  if (code != SUCCESS || !enough_frames(NUM_KSTACK_PAGES)) {
+    TracePrintf(1, "Spawn of %s failed\n", filename);
+    process_terminate(child_node, ERROR); // never ran, so no one to tell
+    process_destroy(child_node);
+    return ERROR;
+  }
+  process_adopt(parent, child_node);
+  ready(child_node); // must do it here, because the next line would copy the kernel
+  copy_kernel(child_node); // the child resumes here, on its own kernel stack
+  if (procs->running == parent) return get_pid(child_node);
+  return 0;
+}
+
 void KernelExit (int status) {
   TracePrintf(1, "Process %d Exiting...\n", ((pcb_t*) procs->running->data)->pid);
   if (procs->running == init_node) Halt();
@@ -49,19 +89,48 @@ void KernelExit (int status) {
 }
 
 int KernelWait (int *status_ptr) {
+  return KernelWaitPid(WAIT_ANY, status_ptr, 0);
+}
+
+/* Finds the defunct child with the given pid, or the first one if WAIT_ANY
+ *
+ * @param parent the parent pcb
+ * @param pid the child pid, or WAIT_ANY
+ * @return the defunct child process node, NULL if none
+ */
+node_t *find_defunct(pcb_t *parent, int pid) {
+  if (pid == WAIT_ANY) return parent->d_children->head;
+  for (node_t *curr = parent->d_children->head; curr != NULL; curr = curr->next)
+    if (get_pid(curr) == pid) return curr;
+  return NULL;
+}
+
+int KernelWaitPid (int pid, int *status_ptr, int flags) {
   user_pt_t *curr_pt = ((pcb_t*) procs->running->data)->userpt;
   if (status_ptr != NULL && !check_addr(status_ptr, PROT_WRITE, curr_pt)) return ERROR;
-  TracePrintf(1, "Process %d Waiting for a child...\n", ((pcb_t*) procs->running->data)->pid);
+  if (pid <= 0 && pid != WAIT_ANY) return ERROR;
+  TracePrintf(1, "Process %d Waiting for child %d...\n", ((pcb_t*) procs->running->data)->pid, pid);
   pcb_t *parent = procs->running->data;
-  if (is_empty(parent->a_children) && is_empty(parent->d_children)) {
+  if (pid == WAIT_ANY && is_empty(parent->a_children) && is_empty(parent->d_children)) {
     TracePrintf(1, "Process has no children to wait on. Returning error\n");
     return ERROR;
   }
-  
+  if (pid != WAIT_ANY && find_defunct(parent, pid) == NULL) { // must be an alive child then
+    node_t *curr;
+    for (curr = parent->a_children->head; curr != NULL && ((pcb_t*) curr->data)->pid != pid; curr = curr->next);
+    if (curr == NULL) {
+      TracePrintf(1, "Process %d is not our child. Returning error\n", pid);
+      return ERROR;
+    }
+  }
+
   node_t *child;
-  while ((child = dequeue(parent->d_children)) == NULL)
-    block_wait();
-  
+  while ((child = find_defunct(parent, pid)) == NULL) {
+    if (flags & WAIT_NOHANG) return 0;
+    block_wait(pid); // only that child's (or any child's) exit wakes us
+  }
+  remove(parent->d_children, child);
+
   // now I have the child
   int cid = get_pid(child);
 
@@ -87,10 +156,11 @@ int KernelUserBrk (void *addr) {
   unsigned int next_brk_vpn = (UP_TO_PAGE(addr) >> PAGESHIFT) - 1; // greatest vpn to be used
 
   if (next_brk_vpn > curr_brk_vpn) {
-    if (next_brk_vpn - curr_brk_vpn > frames_left()) return ERROR;
+    if (!pages_free(userpt, curr_brk_vpn + 1, next_brk_vpn + 2)) return ERROR; // keep a page clear of shared memory
+    if (!enough_frames(next_brk_vpn - curr_brk_vpn)) return ERROR;
     userpt->size += next_brk_vpn - curr_brk_vpn;
     for (int vpn = curr_brk_vpn + 1; vpn <= next_brk_vpn; vpn++) {
-      set_pte(&userpt->pt[vpn - BASE_PAGE_1], 1, get_frame(NONE, AUTO), PROT_READ|PROT_WRITE);
+      set_pte(&userpt->pt[vpn - BASE_PAGE_1], 1, get_frame(NONE, AUTO, get_pid(procs->running), FRAME_UHEAP), PROT_READ|PROT_WRITE);
       WriteRegister(REG_TLB_FLUSH, vpn << PAGESHIFT);
     }
   } else if (next_brk_vpn < curr_brk_vpn) {
@@ -118,44 +188,200 @@ int KernelDelay (int clock_ticks) {
   TracePrintf(1, "Process %d returning from Delay\n", ((pcb_t*) procs->running->data)->pid);
   return 0;
 }
+
+int KernelGetTicks (void) {
+  return procs->ticks;
+}
    
 ////////////// I/O Syscalls
 
-int KernelTtyRead (int tty_id, void *buf, int len) {
+int KernelTtyRead (int tty_id, void *buf, int len, int flags) {
   user_pt_t *curr_pt = ((pcb_t *) procs->running->data)->userpt;
-  if (tty_id >= NUM_TERMINALS || !check_buffer(len, buf, PROT_READ, curr_pt)) return ERROR;
-  return read_tty(tty_id, buf, len);
+  if (tty_id < 0 || !check_buffer(len, buf, PROT_WRITE, curr_pt)) return ERROR;
+  if (tty_id < NUM_TERMINALS) return read_tty(tty_id, buf, len, flags);
+  pty_t *pty = find_pty(tty_id); // the slave side of a pseudo-terminal
+  if (pty == NULL) return ERROR;
+  return read_pty_slave(pty, buf, len, flags);
 }
 
-int KernelTtyWrite (int tty_id, void *buf, int len) {
+int KernelTtyWrite (int tty_id, void *buf, int len, int flags) {
   user_pt_t *curr_pt = ((pcb_t *) procs->running->data)->userpt;
-  if (tty_id >= NUM_TERMINALS || !check_buffer(len, buf, PROT_WRITE, curr_pt)) return ERROR;
-  return write_tty(tty_id, buf, len);
+  if (tty_id < 0 || !check_buffer(len, buf, PROT_READ, curr_pt)) return ERROR;
+  if (tty_id < NUM_TERMINALS) return write_tty(tty_id, buf, len, flags);
+  pty_t *pty = find_pty(tty_id);
+  if (pty == NULL) return ERROR;
+  return write_pty_slave(pty, buf, len, flags);
+}
+
+/* Copies an io_vec_t array from userland into the kernel, then checks each segment
+ * of the copy. Only the copy may be used afterwards: the user's array could sit in
+ * shared memory, where another process can change it while we're blocked
+ *
+ * @param iov the user's segments
+ * @param n the # of segments
+ * @param prot PROT_READ if we'll read the segments, PROT_WRITE if we'll write them
+ * @param curr_pt the current user page table
+ * @param copy where to copy the segments, IOV_MAX of them
+ * @return the total length of the segments if all good, ERROR otherwise
+ */
+int check_iov(io_vec_t *iov, int n, int prot, user_pt_t *curr_pt, io_vec_t *copy) {
+  if (n < 0 || n > IOV_MAX || !check_buffer(n * sizeof(io_vec_t), iov, PROT_READ, curr_pt)) return ERROR;
+  memcpy(copy, iov, n * sizeof(io_vec_t));
+  int total = 0;
+  for (int i = 0; i < n; i++) {
+    if (copy[i].len < 0 || !check_buffer(copy[i].len, copy[i].base, prot, curr_pt)) return ERROR;
+    total += copy[i].len;
+  }
+  return total;
+}
+
+int KernelTtyWriteV (int tty_id, io_vec_t *user_iov, int n, int flags) {
+  user_pt_t *curr_pt = ((pcb_t *) procs->running->data)->userpt;
+  io_vec_t iov[IOV_MAX];
+  int total = check_iov(user_iov, n, PROT_READ, curr_pt, iov);
+  pty_t *pty = find_pty(tty_id);
+  if (tty_id < 0 || (tty_id >= NUM_TERMINALS && pty == NULL) || total == ERROR) return ERROR;
+  if (total == 0) return 0;
+  if (pty == NULL) return writev_tty(tty_id, iov, n, flags);
+  if (total > PTY_RING) { // segment by segment: not atomic, but no big copy
+    int written = 0;
+    for (int i = 0; i < n; i++) {
+      int w = write_pty_slave(pty, iov[i].base, iov[i].len, flags);
+      if (w == WOULD_BLOCK) break;
+      written += w;
+      if (w < iov[i].len) break;
+    }
+    return written > 0 ? written : WOULD_BLOCK;
+  }
+  char *gathered = kmalloc(total, KH_TTY); // one write, so it goes out in one piece; at most PTY_RING
+  if (gathered == NULL) return ERROR;
+  for (int i = 0, at = 0; i < n; at += iov[i++].len) memcpy(gathered + at, iov[i].base, iov[i].len);
+  int written = write_pty_slave(pty, gathered, total, flags);
+  kfree(gathered);
+  return written;
+}
+
+int KernelPtyOpen (int *pty_idp) {
+  user_pt_t *curr_pt = ((pcb_t *) procs->running->data)->userpt;
+  if (!check_buffer(sizeof(int), pty_idp, PROT_WRITE, curr_pt) || no_kernel_memory(1)) return ERROR;
+  int id = new_pty();
+  if (id == ERROR) return ERROR;
+  *pty_idp = id;
+  return 0;
+}
+
+int KernelPtyClose (int pty_id) {
+  return destroy_pty(pty_id);
+}
+
+int KernelPtyRead (int pty_id, void *buf, int len, int flags) {
+  pty_t *pty = find_pty(pty_id);
+  user_pt_t *curr_pt = ((pcb_t *) procs->running->data)->userpt;
+  if (pty == NULL || len <= 0 || !check_buffer(len, buf, PROT_WRITE, curr_pt)) return ERROR;
+  return read_pty(pty, buf, len, flags);
+}
+
+int KernelPtyWrite (int pty_id, void *buf, int len) {
+  pty_t *pty = find_pty(pty_id);
+  user_pt_t *curr_pt = ((pcb_t *) procs->running->data)->userpt;
+  if (pty == NULL || len < 0 || !check_buffer(len, buf, PROT_READ, curr_pt)) return ERROR;
+  return write_pty(pty, buf, len);
 }
 
 //////////////// IPC Syscalls
 
+int KernelShmCreate (int size) {
+  if (size <= 0 || size > VMEM_1_SIZE) return ERROR;
+  int npages = UP_TO_PAGE(size) >> PAGESHIFT;
+  if (no_kernel_memory(npages + 1)) return ERROR;
+  node_t *s = new_shm(new_id(), npages);
+  return s == NULL ? ERROR : s->code;
+}
+
+int KernelShmAttach (int shm_id, void *addr) {
+  node_t *s = find_shm(shm_id);
+  if (s == NULL) return ERROR;
+  shm_t *shm = s->data;
+  return map_shared(((pcb_t *) procs->running->data)->userpt, shm->pfns, shm->npages, addr);
+}
+
+int KernelShmDetach (void *addr) {
+  return unmap_shared(((pcb_t *) procs->running->data)->userpt, addr);
+}
+
+int KernelFutexWait (int *addr, int val) {
+  user_pt_t *curr_pt = ((pcb_t *) procs->running->data)->userpt;
+  if (((unsigned int) addr & 3) || !check_buffer(sizeof(int), addr, PROT_READ|PROT_WRITE, curr_pt)) return ERROR;
+  return futex_wait(user_paddr(curr_pt, addr), addr, val);
+}
+
+int KernelFutexWake (int *addr, int n) {
+  user_pt_t *curr_pt = ((pcb_t *) procs->running->data)->userpt;
+  if (((unsigned int) addr & 3) || n < 0 || !check_buffer(sizeof(int), addr, PROT_READ|PROT_WRITE, curr_pt)) return ERROR;
+  return futex_wake(user_paddr(curr_pt, addr), n);
+}
+
 int KernelPipeInit (int *pipe_idp) {
   if (no_kernel_memory(1)) return ERROR;
   user_pt_t *curr_pt = ((pcb_t *) procs->running->data)->userpt;
   if (!check_addr(pipe_idp, PROT_WRITE, curr_pt)) return ERROR;
-  node_t* p = new_pipe(new_id());
+  node_t* p = new_pipe(new_id(), PIPE_BUFFER_LEN);
   if (pipe_idp != NULL) *pipe_idp = p->code;
   return 0;
 }
 
-int KernelPipeRead (int pipe_id, void *buf, int len) {
+int KernelPipeInitCap (int *pipe_idp, int cap) {
+  if (cap < 1 || cap > PIPE_MAX_CAPACITY) return ERROR;
+  if (no_kernel_memory(1)) return ERROR;
+  user_pt_t *curr_pt = ((pcb_t *) procs->running->data)->userpt;
+  if (!check_addr(pipe_idp, PROT_WRITE, curr_pt)) return ERROR;
+  node_t* p = new_pipe(new_id(), cap);
+  *pipe_idp = p->code;
+  return 0;
+}
+
+int KernelPipeSetCap (int pipe_id, int cap) {
+  node_t *p = find_pipe(pipe_id);
+  if (p == NULL) return ERROR;
+  return set_pipe_cap(p, cap);
+}
+
+int KernelPipeRead (int pipe_id, void *buf, int len, int flags) {
   node_t *p = find_pipe(pipe_id);
   user_pt_t *curr_pt = ((pcb_t *) procs->running->data)->userpt;
-  if (p == NULL || !check_buffer(len, buf, PROT_READ, curr_pt)) return ERROR; /// what if failed?
-  return read_pipe(p, buf, len);
+  if (p == NULL || !check_buffer(len, buf, PROT_WRITE, curr_pt)) return ERROR; // we write into buf
+  return read_pipe(p, buf, len, flags);
 }
 
-int KernelPipeWrite (int pipe_id, void *buf, int len) {
+int KernelPipeWrite (int pipe_id, void *buf, int len, int flags) {
   node_t *p = find_pipe(pipe_id); /// what if failed?
   user_pt_t *curr_pt = ((pcb_t *) procs->running->data)->userpt;
-  if (p == NULL || !check_buffer(len, buf, PROT_WRITE, curr_pt)) return ERROR;
-  return write_pipe(p, buf, len);
+  if (p == NULL || !check_buffer(len, buf, PROT_READ, curr_pt)) return ERROR; // we only read buf
+  return write_pipe(p, buf, len, flags);
+}
+
+int KernelPipeWriteV (int pipe_id, io_vec_t *user_iov, int n, int flags) {
+  node_t *p = find_pipe(pipe_id);
+  user_pt_t *curr_pt = ((pcb_t *) procs->running->data)->userpt;
+  io_vec_t iov[IOV_MAX];
+  if (p == NULL || check_iov(user_iov, n, PROT_READ, curr_pt, iov) == ERROR) return ERROR;
+  return writev_pipe(p, iov, n, flags);
+}
+
+int KernelPipeReadV (int pipe_id, io_vec_t *user_iov, int n, int flags) {
+  node_t *p = find_pipe(pipe_id);
+  user_pt_t *curr_pt = ((pcb_t *) procs->running->data)->userpt;
+  io_vec_t iov[IOV_MAX];
+  if (p == NULL || check_iov(user_iov, n, PROT_WRITE, curr_pt, iov) == ERROR) return ERROR;
+  return readv_pipe(p, iov, n, flags);
+}
+
+int KernelPoll (poll_entry_t *fds, int n, int timeout) {
+  user_pt_t *curr_pt = ((pcb_t *) procs->running->data)->userpt;
+  if (n < 0 || n > POLL_MAX || timeout < POLL_FOREVER) return ERROR;
+  if (!check_buffer(n * sizeof(poll_entry_t), fds, PROT_WRITE, curr_pt)) return ERROR;
+  if (no_kernel_memory(0)) return ERROR; // registering takes a little kernel heap
+  return poll(fds, n, timeout);
 }
 
 //////////// Synchronization Syscalls
@@ -172,7 +398,13 @@ int KernelLockInit (int *lock_idp) {
 int KernelAcquire (int lock_id) {
   node_t* l = find_lock(lock_id);
   if (l == NULL) return ERROR;
-  return acquire(l);
+  return acquire(l, WAIT_FOREVER);
+}
+
+int KernelAcquireTimeout (int lock_id, int ticks) {
+  node_t* l = find_lock(lock_id);
+  if (l == NULL || ticks < 0) return ERROR;
+  return acquire(l, ticks);
 }
 
 int KernelRelease (int lock_id) {
@@ -181,6 +413,13 @@ int KernelRelease (int lock_id) {
   return release(l);
 }
 
+int KernelLockSetMode (int lock_id, int mode) {
+  node_t* l = find_lock(lock_id);
+  if (l == NULL || (mode != LOCK_MESA && mode != LOCK_HANDOFF)) return ERROR;
+  ((lock_t *) l->data)->mode = mode;
+  return 0;
+}
+
 int KernelCvarInit (int *cvar_idp) {
   if (no_kernel_memory(1)) return ERROR;
   user_pt_t *curr_pt = ((pcb_t *) procs->running->data)->userpt;
@@ -193,10 +432,16 @@ int KernelCvarInit (int *cvar_idp) {
 int KernelCvarWait (int cvar_id, int lock_id) {
   node_t *l = find_lock(lock_id), *c = find_cvar(cvar_id);
   if (l == NULL || c == NULL) return ERROR;
-  wait_cvar(c, l);
+  wait_cvar(c, l, WAIT_FOREVER);
   return 0;
 }
 
+int KernelCvarTimedWait (int cvar_id, int lock_id, int ticks) {
+  node_t *l = find_lock(lock_id), *c = find_cvar(cvar_id);
+  if (l == NULL || c == NULL || ticks <= 0) return ERROR;
+  return wait_cvar(c, l, ticks);
+}
+
 int KernelCvarSignal (int cvar_id) {
   node_t* c = find_cvar(cvar_id);
   if (c == NULL) return ERROR;
@@ -211,10 +456,118 @@ int KernelCvarBroadcast (int cvar_id) {
   return 0;
 }
 
+int KernelRWLockInit (int *rwlock_idp) {
+  if (no_kernel_memory(1)) return ERROR;
+  user_pt_t *curr_pt = ((pcb_t *) procs->running->data)->userpt;
+  if (!check_addr(rwlock_idp, PROT_WRITE, curr_pt)) return ERROR;
+  node_t *rw = new_rwlock(new_id());
+  if (rwlock_idp != NULL) *rwlock_idp = rw->code;
+  return 0;
+}
+
+// whether the running process already holds the rwlock, for reading or writing
+int holds_rwlock(node_t *rw_n) {
+  rwlock_t *rw = rw_n->data;
+  return rw->writer == procs->running || find(rw->readers, get_pid(procs->running)) != NULL;
+}
+
+int KernelReadAcquire (int rwlock_id) {
+  node_t *rw = find_rwlock(rwlock_id);
+  if (rw == NULL || holds_rwlock(rw)) return ERROR; // would deadlock behind a waiting writer
+  if (no_kernel_memory(1)) return ERROR; // for our read hold
+  read_acquire(rw);
+  return 0;
+}
+
+int KernelWriteAcquire (int rwlock_id) {
+  node_t *rw = find_rwlock(rwlock_id);
+  if (rw == NULL || holds_rwlock(rw)) return ERROR; // would deadlock
+  write_acquire(rw);
+  return 0;
+}
+
+int KernelRWRelease (int rwlock_id) {
+  node_t *rw = find_rwlock(rwlock_id);
+  if (rw == NULL) return ERROR;
+  return rw_release(rw);
+}
+
+int KernelSemInit (int *sem_idp, int count) {
+  if (count < 0 || no_kernel_memory(1)) return ERROR;
+  user_pt_t *curr_pt = ((pcb_t *) procs->running->data)->userpt;
+  if (!check_addr(sem_idp, PROT_WRITE, curr_pt)) return ERROR;
+  node_t *s = new_sem(new_id(), count);
+  if (sem_idp != NULL) *sem_idp = s->code;
+  return 0;
+}
+
+int KernelSemUp (int sem_id) {
+  node_t *s = find_sem(sem_id);
+  if (s == NULL) return ERROR;
+  sem_up(s);
+  return 0;
+}
+
+int KernelSemDown (int sem_id) {
+  node_t *s = find_sem(sem_id);
+  if (s == NULL) return ERROR;
+  sem_down(s);
+  return 0;
+}
+
+int KernelBarrierInit (int *barrier_idp, int n) {
+  if (n <= 0 || no_kernel_memory(1)) return ERROR;
+  user_pt_t *curr_pt = ((pcb_t *) procs->running->data)->userpt;
+  if (!check_addr(barrier_idp, PROT_WRITE, curr_pt)) return ERROR;
+  node_t *b = new_barrier(new_id(), n);
+  if (barrier_idp != NULL) *barrier_idp = b->code;
+  return 0;
+}
+
+int KernelBarrierWait (int barrier_id) {
+  node_t *b = find_barrier(barrier_id);
+  if (b == NULL) return ERROR;
+  barrier_wait(b);
+  return 0;
+}
+
 int KernelReclaim (int id) {
-  node_t *l = find_lock(id), *c = find_cvar(id), *p = find_pipe(id);
-  if (!(p || c || l)) return ERROR;
+  node_t *l = find_lock(id), *c = find_cvar(id), *p = find_pipe(id), *s = find_shm(id), *rw = find_rwlock(id);
+  node_t *sem = find_sem(id), *b = find_barrier(id);
+  if (!(p || c || l || s || rw || sem || b)) return ERROR;
+  else if (s) return destroy_shm(s);
+  else if (rw) return destroy_rwlock(rw);
+  else if (sem) return destroy_sem(sem);
+  else if (b) return destroy_barrier(b);
   else if (p) return destroy_pipe(p);
   else if (c) return destroy_cvar(c);
   else return destroy_lock(l);
 }
+
+//////////// Statistics Syscalls
+
+int KernelIpcStat (int id, ipc_stat_t *stat) {
+  user_pt_t *curr_pt = ((pcb_t *) procs->running->data)->userpt;
+  if (!check_buffer(sizeof(ipc_stat_t), stat, PROT_WRITE, curr_pt)) return ERROR;
+  return stat_ipc(id, stat);
+}
+
+int KernelIpcList (ipc_stat_t *stats, int max) {
+  user_pt_t *curr_pt = ((pcb_t *) procs->running->data)->userpt;
+  if (max < 0 || !check_buffer(max * sizeof(ipc_stat_t), stats, PROT_WRITE, curr_pt)) return ERROR;
+  return list_ipc(stats, max);
+}
+
+int KernelMemInfo (mem_info_t *info) {
+  user_pt_t *curr_pt = ((pcb_t *) procs->running->data)->userpt;
+  if (!check_buffer(sizeof(mem_info_t), info, PROT_WRITE, curr_pt)) return ERROR;
+  mem_info(info);
+  return 0;
+}
+
+int KernelKHeapInfo (kheap_info_t *info) {
+  user_pt_t *curr_pt = ((pcb_t *) procs->running->data)->userpt;
+  if (!check_buffer(sizeof(kheap_info_t), info, PROT_WRITE, curr_pt)) return ERROR;
+  kheap_info(info);
+  return 0;
+}
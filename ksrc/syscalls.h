@@ -37,6 +37,18 @@ int KernelFork (void);
  */
 int KernelExec (char *filename, char **argvec);
 
+/* Creates a new child process running the program stored in filename
+ * with args argvec, as Fork() then Exec() in the child would, but without
+ * copying the parent's address space: the program is loaded straight
+ * into the child's fresh region 1.
+ *
+ * @param filename the filename of the new program to run
+ * @param argvec the args for this new program
+ * @return the pid of the child to the parent, ERROR if the args are invalid,
+ *         the program can't be loaded, or not enough memory
+ */
+int KernelSpawn (char *filename, char **argvec);
+
 /* Per Yalnix Manual:
  * - The current process is terminated, status value is saved 
  * for possible later collection by the parent Wait. Frees all unneeded resources.
@@ -58,6 +70,19 @@ void KernelExit (int status);
  */
 int KernelWait (int *status_ptr);
 
+/* Collects the pid and exit status of the given child, or of any child
+ * if pid is WAIT_ANY. If status ptr is not null, the exit status
+ * is copied to that address. Blocks on our own wait channel until that
+ * child exits, unless WAIT_NOHANG is in flags.
+ *
+ * @param pid the child pid to collect, or WAIT_ANY
+ * @param status_ptr the pointer to save exit status to
+ * @param flags 0 or WAIT_NOHANG
+ * @return the pid of exited child on success, 0 if WAIT_NOHANG and it hasn't exited yet,
+ *         ERROR if pid isn't our child (or no remaining children for WAIT_ANY)
+ */
+int KernelWaitPid (int pid, int *status_ptr, int flags);
+
 /* Gets the pid of the calling process
  *
  * @return the pid of the calling process
@@ -81,6 +106,12 @@ int KernelUserBrk (void *addr);
  */
 int KernelDelay (int clock_ticks);
 
+/* Gets the # of clock-ticks since boot, for timing user programs
+ *
+ * @return the # of clock-ticks since boot
+ */
+int KernelGetTicks (void);
+
 ////////////// I/O Syscalls
 
 /* Per Yalnix Manual:
@@ -93,27 +124,118 @@ int KernelDelay (int clock_ticks);
  * @param tty_id the terminal id to read from
  * @param buf the buffer to copy into
  * @param len the desired lenth of bytes to copy
+ * @param flags 0 or IO_NONBLOCK
  * @return # of bytes actually copied into the calling 
- *         process’s buffer on success, ERROR otherwise
+ *         process’s buffer on success, WOULD_BLOCK, ERROR otherwise
  */
-int KernelTtyRead (int tty_id, void *buf, int len);
+int KernelTtyRead (int tty_id, void *buf, int len, int flags);
 
 /* Per Yalnix Manual:
  * - Write the contents of the buffer referenced by buf to the terminal tty id.
  * The length of the buffer in bytes is given by len. The calling process is
  * blocked until all chars from the buffer have been written on the terminal. 
+ * Here it only waits until they are all queued in the terminal's output ring.
  *
  * This function calls wrapper function write_tty(); see documentation in pilocvario.h
  *
  * @param tty_id the id of terminal to write to
  * @param buf the characters to write to the terminal
  * @param len the length of bytes to write
- * @return # of bytes written (len) on success, ERROR otherwise
+ * @param flags 0 or IO_NONBLOCK
+ * @return # of bytes written (len, or less if IO_NONBLOCK) on success, WOULD_BLOCK, ERROR otherwise
+ */
+int KernelTtyWrite (int tty_id, void *buf, int len, int flags);
+
+/* Writes the n segments of iov to the terminal tty id, as one TtyWrite
+ * so no other writer's output lands in between
+ *
+ * @param tty_id the id of terminal to write to
+ * @param iov the segments to write
+ * @param n the # of segments, at most IOV_MAX
+ * @param flags 0 or IO_NONBLOCK
+ * @return # of bytes written on success, WOULD_BLOCK, ERROR otherwise
  */
-int KernelTtyWrite (int tty_id, void *buf, int len);
+int KernelTtyWriteV (int tty_id, io_vec_t *iov, int n, int flags);
+
+/* Creates a pseudo-terminal: its slave side is a terminal for TtyRead/TtyWrite
+ * under the returned id, and its master side is driven with PtyRead/PtyWrite
+ *
+ * @param pty_idp where to put the new pty's id
+ * @return 0 on success, ERROR if out of ptys or memory
+ */
+int KernelPtyOpen (int *pty_idp);
+
+/* Frees a pseudo-terminal. See destroy_pty() in pilocvario.h
+ *
+ * @param pty_id the pty's id
+ * @return 0 on success, ERROR if no such pty or someone is blocked on it
+ */
+int KernelPtyClose (int pty_id);
+
+/* Master side: reads what the slave side TtyWrote. See read_pty() in pilocvario.h
+ *
+ * @param pty_id the pty's id
+ * @param buf where to read into
+ * @param len the max # of bytes to read
+ * @param flags 0 or IO_NONBLOCK
+ * @return # of bytes read on success, WOULD_BLOCK, ERROR otherwise
+ */
+int KernelPtyRead (int pty_id, void *buf, int len, int flags);
+
+/* Master side: types into the slave side's input. See write_pty() in pilocvario.h
+ *
+ * @param pty_id the pty's id
+ * @param buf what to type
+ * @param len the # of bytes
+ * @return # of bytes taken on success, ERROR otherwise
+ */
+int KernelPtyWrite (int pty_id, void *buf, int len);
 
 //////////////// IPC Syscalls  
 
+/* Creates a shared memory segment of size bytes (rounded up to pages), zeroed.
+ * It lives until Reclaim(id); its frames until every attachment is gone too
+ *
+ * @param size the segment size in bytes
+ * @return the segment id, ERROR otherwise
+ */
+int KernelShmCreate (int size);
+
+/* Maps the segment into the running process between its heap and stack,
+ * read/write. Children Fork()-ed afterwards inherit the attachment.
+ * See map_shared() in memory.h
+ *
+ * @param shm_id the segment id
+ * @param addr the page-aligned address to map it at, NULL to let the kernel pick
+ * @return the address it is mapped at, ERROR otherwise
+ */
+int KernelShmAttach (int shm_id, void *addr);
+
+/* Unmaps the segment attached at addr from the running process
+ *
+ * @param addr the address ShmAttach returned
+ * @return 0 on success, ERROR otherwise
+ */
+int KernelShmDetach (void *addr);
+
+/* Sleeps on the futex word at addr, if it still holds val. Futexes are keyed
+ * by physical address, so processes sharing the word's page share the futex.
+ * See futex_wait() in pilocvario.h
+ *
+ * @param addr the futex word, int-aligned and writable
+ * @param val the value the caller last saw there
+ * @return 0 once woken by FutexWake, FUTEX_CHANGED if *addr != val, ERROR otherwise
+ */
+int KernelFutexWait (int *addr, int val);
+
+/* Wakes up to n processes sleeping on the futex word at addr
+ *
+ * @param addr the futex word, int-aligned and writable
+ * @param n the most to wake
+ * @return the # woken, ERROR otherwise
+ */
+int KernelFutexWake (int *addr, int n);
+
 /* Creates a new pipe and save its identifier at *pipe_idp.
  *
  * @param pipe_idp the pipe identifier pointer
@@ -121,6 +243,25 @@ int KernelTtyWrite (int tty_id, void *buf, int len);
  */
 int KernelPipeInit (int *pipe_idp);
 
+/* Creates a new pipe that may buffer up to cap bytes, and save its identifier at *pipe_idp.
+ * The pipe's buffer starts small and grows on demand up to cap.
+ *
+ * @param pipe_idp the pipe identifier pointer
+ * @param cap the pipe's capacity, 1 to PIPE_MAX_CAPACITY
+ * @return 0 on success, ERROR otherwise
+ */
+int KernelPipeInitCap (int *pipe_idp, int cap);
+
+/* Changes how many bytes the given pipe may buffer.
+ *
+ * This function calls wrapper function set_pipe_cap(). See pilocvario.h for documentation.
+ *
+ * @param pipe_id the id of the pipe
+ * @param cap the pipe's new capacity, 1 to PIPE_MAX_CAPACITY
+ * @return 0 on success, ERROR otherwise
+ */
+int KernelPipeSetCap (int pipe_id, int cap);
+
 /* Per Yalnix Manual:
  * - Read len consecutive bytes from the named pipe into the buffer
  * starting at address buf, following the standard semantics:
@@ -134,9 +275,10 @@ int KernelPipeInit (int *pipe_idp);
  * @param pipe_id the id of the pipe to read from
  * @param buf the buffer to copy the pipe contents to
  * @param len the desired length of bytes to read
- * @return # of bytes read on success, ERROR otherwise
+ * @param flags 0 or IO_NONBLOCK
+ * @return # of bytes read on success, WOULD_BLOCK, ERROR otherwise
  */
-int KernelPipeRead (int pipe_id, void *buf, int len);
+int KernelPipeRead (int pipe_id, void *buf, int len, int flags);
 
 /* Per Yalnix Manual:
  * - Write the len bytes starting at buf to the named pipe. 
@@ -147,9 +289,47 @@ int KernelPipeRead (int pipe_id, void *buf, int len);
  * @param pipe_id the id of the pipe to write to
  * @param buf the chars to start writing from to the pipe
  * @param len the length of bytes to write
- * @return # of bytes written to the pipe on success, ERROR otherwise
+ * @param flags 0 or IO_NONBLOCK
+ * @return # of bytes written to the pipe on success, WOULD_BLOCK, ERROR otherwise
+ */
+int KernelPipeWrite (int pipe_id, void *buf, int len, int flags);
+
+/* Writes the n segments of iov to the named pipe, atomically with respect
+ * to other writers as long as they fit in the pipe's capacity.
+ *
+ * This function calls wrapper function writev_pipe(). See pilocvario.h for documentation.
+ *
+ * @param pipe_id the id of the pipe to write to
+ * @param iov the segments to write
+ * @param n the # of segments, at most IOV_MAX
+ * @param flags 0 or IO_NONBLOCK
+ * @return # of bytes written to the pipe on success, WOULD_BLOCK, ERROR otherwise
+ */
+int KernelPipeWriteV (int pipe_id, io_vec_t *iov, int n, int flags);
+
+/* Reads from the named pipe into the n segments of iov.
+ *
+ * This function calls wrapper function readv_pipe(). See pilocvario.h for documentation.
+ *
+ * @param pipe_id the id of the pipe to read from
+ * @param iov the segments to fill
+ * @param n the # of segments, at most IOV_MAX
+ * @param flags 0 or IO_NONBLOCK
+ * @return # of bytes read on success, WOULD_BLOCK, ERROR otherwise
+ */
+int KernelPipeReadV (int pipe_id, io_vec_t *iov, int n, int flags);
+
+/* Blocks until any of the n given pipes/terminals is ready for the events asked,
+ * or timeout clock-ticks pass.
+ *
+ * This function calls wrapper function poll(). See pilocvario.h for documentation.
+ *
+ * @param fds the poll entries, revents filled in on return
+ * @param n the # of entries, at most POLL_MAX
+ * @param timeout max # of clock-ticks to block, 0 to not block, POLL_FOREVER to not time out
+ * @return the # of ready entries, 0 on timeout, ERROR otherwise
  */
-int KernelPipeWrite (int pipe_id, void *buf, int len);
+int KernelPoll (poll_entry_t *fds, int n, int timeout);
 
 //////////// Synchronization Syscalls
 
@@ -177,6 +357,24 @@ int KernelAcquire (int lock_id);
  */
 int KernelRelease (int lock_id);
 
+/* Sets how the lock is passed on at Release: LOCK_MESA (the default) wakes
+ * the head waiter to compete for it, LOCK_HANDOFF makes it the owner first
+ *
+ * @param lock_id the id of the lock
+ * @param mode LOCK_MESA or LOCK_HANDOFF
+ * @return 0 on success, ERROR otherwise
+ */
+int KernelLockSetMode (int lock_id, int mode);
+
+/* Acquires the specified lock like KernelAcquire, but gives up after the
+ * given # of clock-ticks. 0 ticks only takes the lock if it's free
+ *
+ * @param lock_id the id of the lock to acquire
+ * @param ticks the most clock-ticks to wait
+ * @return 0 once acquired, TIMEDOUT if it wasn't in time, ERROR otherwise
+ */
+int KernelAcquireTimeout (int lock_id, int ticks);
+
 /* Creates a new cvar and save its identifier at *cvar_idp.
  *
  * @param cvar_idp the cvar identifier pointer
@@ -213,11 +411,123 @@ int KernelCvarBroadcast (int cvar_id);
  */
 int KernelCvarWait (int cvar_id, int lock_id);
 
-/* Reclaims/destroys the specified pipe/lock/cvar and its contents
+/* Like KernelCvarWait, but stops waiting for a signal after the given # of
+ * clock-ticks. Either way the lock is reacquired before returning
+ *
+ * @param cvar_id the id of cvar to wait on
+ * @param lock_id the lock the cvar is contained in
+ * @param ticks the most clock-ticks to wait for a signal, > 0
+ * @return 0 if signaled, TIMEDOUT if not in time, ERROR otherwise
+ */
+int KernelCvarTimedWait (int cvar_id, int lock_id, int ticks);
+
+/* Creates a new reader-writer lock and saves its identifier at *rwlock_idp.
  *
- * @param id the id of pipe/lock/cvar to reclaim/destroy
- * @return 0 on success, ERROR if no pipe/lock/cvar found with specified id
+ * @param rwlock_idp the rwlock identifier pointer
+ * @return 0 on success, ERROR otherwise
+ */
+int KernelRWLockInit (int *rwlock_idp);
+
+/* Acquires the specified rwlock for reading. See read_acquire() in pilocvario.h
+ *
+ * @param rwlock_id the id of the rwlock
+ * @return 0 on success, ERROR otherwise
+ */
+int KernelReadAcquire (int rwlock_id);
+
+/* Acquires the specified rwlock for writing. See write_acquire() in pilocvario.h
+ *
+ * @param rwlock_id the id of the rwlock
+ * @return 0 on success, ERROR otherwise
+ */
+int KernelWriteAcquire (int rwlock_id);
+
+/* Releases the calling process' read or write hold on the specified rwlock
+ *
+ * @param rwlock_id the id of the rwlock
+ * @return 0 on success, ERROR otherwise
+ */
+int KernelRWRelease (int rwlock_id);
+
+/* Creates a new counting semaphore with the given count and saves its identifier at *sem_idp.
+ *
+ * @param sem_idp the semaphore identifier pointer
+ * @param count the initial count, >= 0
+ * @return 0 on success, ERROR otherwise
+ */
+int KernelSemInit (int *sem_idp, int count);
+
+/* Increments the specified semaphore, waking one waiter if any. See sem_up() in pilocvario.h
+ *
+ * @param sem_id the id of the semaphore
+ * @return 0 on success, ERROR otherwise
+ */
+int KernelSemUp (int sem_id);
+
+/* Decrements the specified semaphore, blocking while it's 0. See sem_down() in pilocvario.h
+ *
+ * @param sem_id the id of the semaphore
+ * @return 0 on success, ERROR otherwise
+ */
+int KernelSemDown (int sem_id);
+
+/* Creates a new barrier for n processes and saves its identifier at *barrier_idp.
+ *
+ * @param barrier_idp the barrier identifier pointer
+ * @param n the # of processes each round waits for, > 0
+ * @return 0 on success, ERROR otherwise
+ */
+int KernelBarrierInit (int *barrier_idp, int n);
+
+/* Waits on the specified barrier until n processes have. See barrier_wait() in pilocvario.h
+ *
+ * @param barrier_id the id of the barrier
+ * @return 0 on success, ERROR otherwise
+ */
+int KernelBarrierWait (int barrier_id);
+
+/* Reclaims/destroys the specified pipe/lock/cvar/rwlock/sem/barrier/shm and its contents
+ *
+ * @param id the id of pipe/lock/cvar/rwlock/sem/barrier/shm to reclaim/destroy
+ * @return 0 on success, ERROR if none found with specified id or it's in use
  */
 int KernelReclaim (int id);
 
+//////////// Statistics Syscalls
+
+/* Copies the contention/throughput statistics of the specified
+ * pipe/lock/cvar into *stat. See ycustom.h for the statistics kept
+ *
+ * @param id the id of the pipe/lock/cvar
+ * @param stat the user's ipc_stat_t to fill in
+ * @return 0 on success, ERROR if invalid stat or no pipe/lock/cvar found with id
+ */
+int KernelIpcStat (int id, ipc_stat_t *stat);
+
+/* Copies the statistics of all pipes, locks, and cvars into
+ * the user's array stats, up to max entries
+ *
+ * @param stats the user's array of ipc_stat_t to fill in
+ * @param max the # of entries stats can hold
+ * @return the total # of pipes/locks/cvars alive (may be > max), ERROR if invalid array
+ */
+int KernelIpcList (ipc_stat_t *stats, int max);
+
+/* Summarizes physical frame usage by owner pid and purpose into *info,
+ * along with the largest free run and the # of refused allocations
+ *
+ * @param info the user's mem_info_t to fill in
+ * @return 0 on success, ERROR if invalid info
+ */
+int KernelMemInfo (mem_info_t *info);
+
+/* Copies the kernel heap size and headroom into *info, along with live bytes,
+ * live objects and peak bytes per allocation site if the kernel was built
+ * with KHEAP_PROFILE. See kheap.h
+ *
+ * @param info the user's kheap_info_t to fill in
+ * @return 0 on success, ERROR if invalid info
+ */
+int KernelKHeapInfo (kheap_info_t *info);
+
 #endif // __SYSCALLS_H
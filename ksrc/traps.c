@@ -8,6 +8,91 @@
 // the process table for TrapMemory use
 extern proc_table_t* procs;
 
+/* Executes the custom syscall requested through YALNIX_CUSTOM_0.
+ * regs[0] of uc holds the YC_* code and flags (see ycustom.h), regs[1..3] its args
+ *
+ * @param uc a pointer to the running process' current UserContext
+ * @return the return value of the custom syscall
+ */
+int TrapCustom(UserContext *uc) {
+  int flags = (unsigned int) uc->regs[0] >> YC_FLAGS_SHIFT;
+  switch (uc->regs[0] & YC_CODE_MASK) {
+    case YC_IPC_STAT:
+      return KernelIpcStat((int) uc->regs[1], (ipc_stat_t *) uc->regs[2]);
+    case YC_IPC_LIST:
+      return KernelIpcList((ipc_stat_t *) uc->regs[1], (int) uc->regs[2]);
+    case YC_MEM_INFO:
+      return KernelMemInfo((mem_info_t *) uc->regs[1]);
+    case YC_KHEAP_INFO:
+      return KernelKHeapInfo((kheap_info_t *) uc->regs[1]);
+    case YC_GET_TICKS:
+      return KernelGetTicks();
+    case YC_SPAWN:
+      return KernelSpawn((char *) uc->regs[1], (char **) uc->regs[2]);
+    case YC_WAITPID:
+      return KernelWaitPid(uc->regs[1], (int *) uc->regs[2], uc->regs[3]);
+    case YC_PIPE_INIT_CAP:
+      return KernelPipeInitCap((int *) uc->regs[1], uc->regs[2]);
+    case YC_PIPE_SET_CAP:
+      return KernelPipeSetCap(uc->regs[1], uc->regs[2]);
+    case YC_POLL:
+      return KernelPoll((poll_entry_t *) uc->regs[1], uc->regs[2], uc->regs[3]);
+    case YC_PIPE_READ:
+      return KernelPipeRead(uc->regs[1], (void *) uc->regs[2], uc->regs[3], flags);
+    case YC_PIPE_WRITE:
+      return KernelPipeWrite(uc->regs[1], (void *) uc->regs[2], uc->regs[3], flags);
+    case YC_TTY_READ:
+      return KernelTtyRead(uc->regs[1], (void *) uc->regs[2], uc->regs[3], flags);
+    case YC_TTY_WRITE:
+      return KernelTtyWrite(uc->regs[1], (void *) uc->regs[2], uc->regs[3], flags);
+    case YC_PIPE_READV:
+      return KernelPipeReadV(uc->regs[1], (io_vec_t *) uc->regs[2], uc->regs[3], flags);
+    case YC_PIPE_WRITEV:
+      return KernelPipeWriteV(uc->regs[1], (io_vec_t *) uc->regs[2], uc->regs[3], flags);
+    case YC_TTY_WRITEV:
+      return KernelTtyWriteV(uc->regs[1], (io_vec_t *) uc->regs[2], uc->regs[3], flags);
+    case YC_PTY_OPEN:
+      return KernelPtyOpen((int *) uc->regs[1]);
+    case YC_PTY_CLOSE:
+      return KernelPtyClose(uc->regs[1]);
+    case YC_PTY_READ:
+      return KernelPtyRead(uc->regs[1], (void *) uc->regs[2], uc->regs[3], flags);
+    case YC_PTY_WRITE:
+      return KernelPtyWrite(uc->regs[1], (void *) uc->regs[2], uc->regs[3]);
+    case YC_FUTEX_WAIT:
+      return KernelFutexWait((int *) uc->regs[1], uc->regs[2]);
+    case YC_FUTEX_WAKE:
+      return KernelFutexWake((int *) uc->regs[1], uc->regs[2]);
+    case YC_SHM_CREATE:
+      return KernelShmCreate(uc->regs[1]);
+    case YC_SHM_ATTACH:
+      return KernelShmAttach(uc->regs[1], (void *) uc->regs[2]);
+    case YC_SHM_DETACH:
+      return KernelShmDetach((void *) uc->regs[1]);
+    case YC_LOCK_SET_MODE:
+      return KernelLockSetMode(uc->regs[1], uc->regs[2]);
+    case YC_CVAR_TIMED_WAIT:
+      return KernelCvarTimedWait(uc->regs[1], uc->regs[2], uc->regs[3]);
+    case YC_ACQUIRE_TIMEOUT:
+      return KernelAcquireTimeout(uc->regs[1], uc->regs[2]);
+    case YC_RWLOCK_INIT:
+      return KernelRWLockInit((int *) uc->regs[1]);
+    case YC_READ_ACQUIRE:
+      return KernelReadAcquire(uc->regs[1]);
+    case YC_WRITE_ACQUIRE:
+      return KernelWriteAcquire(uc->regs[1]);
+    case YC_RW_RELEASE:
+      return KernelRWRelease(uc->regs[1]);
+    case YC_BARRIER_INIT:
+      return KernelBarrierInit((int *) uc->regs[1], uc->regs[2]);
+    case YC_BARRIER_WAIT:
+      return KernelBarrierWait(uc->regs[1]);
+    default:
+      TracePrintf(1, "custom syscall unhandled \n");
+      return ERROR;
+  }
+}
+
 void TrapKernel(UserContext *uc) {
   save_uc(uc);
   TracePrintf(1, "The code of syscall is 0x%x\n", uc->code);
@@ -39,19 +124,19 @@ void TrapKernel(UserContext *uc) {
       return_val = KernelDelay((int) uc->regs[0]);
       break;
     case YALNIX_TTY_READ:
-      return_val = KernelTtyRead((int) uc->regs[0], (void*) uc->regs[1], (int) uc->regs[2]);
+      return_val = KernelTtyRead((int) uc->regs[0], (void*) uc->regs[1], (int) uc->regs[2], 0);
       break;
     case YALNIX_TTY_WRITE:
-      return_val = KernelTtyWrite((int) uc->regs[0], (void*) uc->regs[1], (int) uc->regs[2]);
+      return_val = KernelTtyWrite((int) uc->regs[0], (void*) uc->regs[1], (int) uc->regs[2], 0);
       break;
     case YALNIX_PIPE_INIT:
       return_val = KernelPipeInit((void *) uc->regs[0]);
       break;
     case YALNIX_PIPE_READ:
-      return_val = KernelPipeRead((int) uc->regs[0], (void*) uc->regs[1], (int) uc->regs[2]);
+      return_val = KernelPipeRead((int) uc->regs[0], (void*) uc->regs[1], (int) uc->regs[2], 0);
       break;
     case YALNIX_PIPE_WRITE:
-      return_val = KernelPipeWrite((int) uc->regs[0], (void*) uc->regs[1], (int) uc->regs[2]);
+      return_val = KernelPipeWrite((int) uc->regs[0], (void*) uc->regs[1], (int) uc->regs[2], 0);
       break;
     case YALNIX_LOCK_INIT:
       return_val = KernelLockInit((int *) uc->regs[0]);
@@ -74,9 +159,21 @@ void TrapKernel(UserContext *uc) {
     case YALNIX_CVAR_WAIT:
       return_val = KernelCvarWait((int) uc->regs[0], (int) uc->regs[1]);
       break;
+    case YALNIX_SEM_INIT:
+      return_val = KernelSemInit((int *) uc->regs[0], (int) uc->regs[1]);
+      break;
+    case YALNIX_SEM_UP:
+      return_val = KernelSemUp((int) uc->regs[0]);
+      break;
+    case YALNIX_SEM_DOWN:
+      return_val = KernelSemDown((int) uc->regs[0]);
+      break;
     case YALNIX_RECLAIM:
       return_val = KernelReclaim((int) uc->regs[0]);
       break;
+    case YALNIX_CUSTOM_0:
+      return_val = TrapCustom(uc);
+      break;
     default :
       TracePrintf(1, "syscall unhandled \n");
   }
@@ -86,7 +183,10 @@ void TrapKernel(UserContext *uc) {
 
 void TrapClock(UserContext *uc) {
   save_uc(uc);
+  procs->ticks++;
   check_delay();
+  check_poll();
+  check_timers();
   rr_preempt();
   restore_uc(uc);
 }
@@ -100,16 +200,26 @@ void TrapMemory(UserContext *uc) {
   save_uc(uc);
   TracePrintf(1, "TrapMemory at 0x%x\n", uc->addr);
   user_pt_t *userpt = ((pcb_t *)procs->running->data)->userpt;
-  if ((unsigned int) uc->addr >= UP_TO_PAGE(userpt->brk) + PAGESIZE && (unsigned int) uc->addr <= DOWN_TO_PAGE(userpt->stack_low)) {
+  int cow = break_cow(userpt, (unsigned int) uc->addr >> PAGESHIFT);
+  if (cow == ERROR) {
+    TracePrintf(0, "Not enough free frames to copy a copy-on-write page, aborting\n");
+    KernelExit(ERROR);
+  }
+  else if (cow == 1) TracePrintf(1, "Broke copy-on-write page\n"); // a write to a shared page, now ours
+  else if ((unsigned int) uc->addr >= UP_TO_PAGE(userpt->brk) + PAGESIZE && (unsigned int) uc->addr <= DOWN_TO_PAGE(userpt->stack_low)) {
     TracePrintf(1, "Expanding User Stack...\n");
     int curr_vpn = DOWN_TO_PAGE(userpt->stack_low) >> PAGESHIFT;
     int next_vpn = DOWN_TO_PAGE(uc->addr) >> PAGESHIFT;
-    if (curr_vpn - next_vpn > frames_left()) {
+    if (!pages_free(userpt, next_vpn - 1, curr_vpn)) {
+      TracePrintf(0, "Aborting: user stack would run into shared memory\n");
+      KernelExit(ERROR);
+    }
+    if (!enough_frames(curr_vpn - next_vpn)) {
       TracePrintf(0, "Not enough free frames, aborting\n");
       KernelExit(ERROR);
     }
     for (int vpn = curr_vpn - 1; vpn >= next_vpn; vpn--) {
-      set_pte(&userpt->pt[vpn - BASE_PAGE_1], 1, get_frame(NONE, AUTO), PROT_READ|PROT_WRITE);
+      set_pte(&userpt->pt[vpn - BASE_PAGE_1], 1, get_frame(NONE, AUTO, KernelGetPid(), FRAME_USTACK), PROT_READ|PROT_WRITE);
       WriteRegister(REG_TLB_FLUSH, vpn << PAGESHIFT);
     }
     userpt->size += curr_vpn - next_vpn;
@@ -0,0 +1,251 @@
+/* Erich Woo & Boxian Wang
+ * 2 December 2020
+ * Custom syscall codes and structures shared by the kernel and user programs
+ *
+ * Our extra syscalls all go through the YALNIX_CUSTOM_0 trap:
+ * regs[0] holds one of the YC_* codes below, and regs[1..3] hold its args.
+ * This header must stay free of kernel/user includes, since both sides use it.
+ */
+
+#ifndef __YCUSTOM_H
+#define __YCUSTOM_H
+
+/////////////// Custom syscall codes (regs[0] of YALNIX_CUSTOM_0)
+
+// regs[0] is the op word: a YC_* code in the low bits, per-call flags above YC_FLAGS_SHIFT
+#define YC_CODE_MASK 0xffff
+#define YC_FLAGS_SHIFT 16
+#define YC_OP(code, flags) ((code) | ((flags) << YC_FLAGS_SHIFT))
+
+#define YC_IPC_STAT 1 // IpcStat(id, ipc_stat_t *stat)
+#define YC_IPC_LIST 2 // IpcList(ipc_stat_t *stats, int max)
+#define YC_MEM_INFO 3 // MemInfo(mem_info_t *info)
+#define YC_KHEAP_INFO 4 // KHeapInfo(kheap_info_t *info)
+#define YC_GET_TICKS 5 // GetTicks(void)
+#define YC_SPAWN 6 // Spawn(char *filename, char **argvec)
+#define YC_WAITPID 7 // WaitPid(int pid, int *status_ptr, int flags)
+#define YC_PIPE_INIT_CAP 8 // PipeInitCap(int *pipe_idp, int cap)
+#define YC_PIPE_SET_CAP 9 // PipeSetCap(int pipe_id, int cap)
+#define YC_POLL 10 // Poll(poll_entry_t *fds, int n, int timeout)
+#define YC_PIPE_READ 11 // PipeRead(int pipe_id, void *buf, int len), with flags
+#define YC_PIPE_WRITE 12 // PipeWrite(int pipe_id, void *buf, int len), with flags
+#define YC_TTY_READ 13 // TtyRead(int tty_id, void *buf, int len), with flags
+#define YC_TTY_WRITE 14 // TtyWrite(int tty_id, void *buf, int len), with flags
+#define YC_PIPE_READV 15 // PipeReadV(int pipe_id, io_vec_t *iov, int n), with flags
+#define YC_PIPE_WRITEV 16 // PipeWriteV(int pipe_id, io_vec_t *iov, int n), with flags
+#define YC_TTY_WRITEV 17 // TtyWriteV(int tty_id, io_vec_t *iov, int n), with flags
+#define YC_PTY_OPEN 18  // PtyOpen(int *pty_idp)
+#define YC_PTY_CLOSE 19 // PtyClose(int pty_id)
+#define YC_PTY_READ 20  // PtyRead(int pty_id, void *buf, int len), with flags
+#define YC_PTY_WRITE 21 // PtyWrite(int pty_id, void *buf, int len)
+#define YC_FUTEX_WAIT 22 // FutexWait(int *addr, int val)
+#define YC_FUTEX_WAKE 23 // FutexWake(int *addr, int n)
+#define YC_SHM_CREATE 24 // ShmCreate(int size)
+#define YC_SHM_ATTACH 25 // ShmAttach(int shm_id, void *addr)
+#define YC_SHM_DETACH 26 // ShmDetach(void *addr)
+#define YC_LOCK_SET_MODE 27 // LockSetMode(int lock_id, int mode)
+#define YC_CVAR_TIMED_WAIT 28 // CvarTimedWait(int cvar_id, int lock_id, int ticks)
+#define YC_ACQUIRE_TIMEOUT 29 // AcquireTimeout(int lock_id, int ticks)
+#define YC_RWLOCK_INIT 30   // RWLockInit(int *rwlock_idp)
+#define YC_READ_ACQUIRE 31  // ReadAcquire(int rwlock_id)
+#define YC_WRITE_ACQUIRE 32 // WriteAcquire(int rwlock_id)
+#define YC_RW_RELEASE 33    // RWRelease(int rwlock_id)
+#define YC_BARRIER_INIT 34  // BarrierInit(int *barrier_idp, int n)
+#define YC_BARRIER_WAIT 35  // BarrierWait(int barrier_id)
+
+/////////////// I/O flags
+
+#define IO_NONBLOCK 0x1 // return WOULD_BLOCK (or a short write count) instead of blocking
+#define WOULD_BLOCK (-3) // nonblocking call that would have had to block
+
+/////////////// Processes
+
+#define WAIT_ANY (-1) // WaitPid() on any child
+#define WAIT_NOHANG 0x1 // WaitPid() returns 0 instead of blocking if no child is ready
+
+/////////////// Pipes
+
+#define PIPE_MAX_CAPACITY 16384 // max PipeInitCap()/PipeSetCap() capacity, in bytes
+
+/////////////// Pseudo-terminals
+
+// pty ids follow the hardware terminals' (NUM_TERMINALS, NUM_TERMINALS + 1, ...),
+// so the slave side works with TtyRead/TtyWrite like any terminal
+#define MAX_PTYS 64
+
+/////////////// Locks
+
+#define LOCK_MESA 0    // Release() wakes the head waiter, which competes for the lock again (default)
+#define LOCK_HANDOFF 1 // Release() makes the head waiter the owner before waking it, FIFO
+#define TIMEDOUT (-4)  // CvarTimedWait()/AcquireTimeout() gave up waiting
+#define WAIT_FOREVER (-1) // no timeout, for the kernel's timed waits
+
+/////////////// Futexes
+
+#define FUTEX_CHANGED 1 // FutexWait() didn't sleep: *addr no longer held val
+
+/////////////// Vectored I/O
+
+#define IOV_MAX 16 // max segments per PipeReadV/PipeWriteV/TtyWriteV
+
+typedef struct io_vec { // one segment of a scatter/gather buffer
+  void *base;
+  int len;
+} io_vec_t;
+
+/////////////// Poll
+
+#define POLL_TTY 0  // poll_entry_t kinds; a pseudo-terminal id polls its slave side, like a terminal
+#define POLL_PIPE 1
+#define POLL_PTY 2  // the master side of a pseudo-terminal: PtyRead/PtyWrite
+#define POLL_IN 0x1  // readable: a terminal has input, a pipe has data, a pty master has output to read
+#define POLL_OUT 0x2 // writable: a terminal isn't transmitting, a pipe has space, a pty master can type a line
+#define POLL_MAX 32  // max entries per Poll()
+#define POLL_FOREVER (-1) // Poll() timeout to never time out
+
+typedef struct poll_entry {
+  int id;      // terminal # or pipe id
+  int kind;    // POLL_TTY, POLL_PIPE or POLL_PTY
+  int events;  // POLL_IN and/or POLL_OUT to wait for
+  int revents; // filled in: which of events are ready
+} poll_entry_t;
+
+/////////////// IPC statistics
+
+// the kinds of pipe/lock/cvar objects
+#define IPC_PIPE 0
+#define IPC_LOCK 1
+#define IPC_CVAR 2
+#define IPC_RWLOCK 3
+#define IPC_SEM 4
+#define IPC_BARRIER 5
+
+typedef struct lock_stat {
+  int acquires;          // total successful acquires
+  int contended;         // acquires that had to block at least once
+  int blocked_ticks;     // total clock ticks spent blocked acquiring
+  int max_blocked_ticks; // longest single blocked acquire, in ticks
+  int wakeups;           // waiters woken by Release
+  int wasted_wakeups;    // wakeups that found the lock taken again and went back to sleep
+  int timeouts;          // AcquireTimeout calls that gave up
+} lock_stat_t;
+
+typedef struct cvar_stat {
+  int waits;      // total CvarWait calls
+  int signals;    // total CvarSignal calls
+  int broadcasts; // total CvarBroadcast calls
+  int spurious;   // waiters that woke up only to block again on the lock
+  int timeouts;   // CvarTimedWait calls that timed out before being signaled
+} cvar_stat_t;
+
+typedef struct rwlock_stat {
+  int read_acquires;  // total ReadAcquire calls
+  int write_acquires; // total WriteAcquire calls
+  int read_blocks;    // readers that had to wait behind a writer
+  int write_blocks;   // writers that had to wait
+  int batches;        // groups of waiting readers let in together by a writer's release
+  int max_batch;      // most readers let in by one release
+} rwlock_stat_t;
+
+typedef struct sem_stat {
+  int downs;  // total SemDown calls
+  int ups;    // total SemUp calls
+  int blocks; // SemDowns that found the count at 0 and had to wait
+  int count;  // current count
+} sem_stat_t;
+
+typedef struct barrier_stat {
+  int waits;    // total BarrierWait calls
+  int releases; // times all n processes arrived and were let go together
+  int n;        // # of processes it waits for
+} barrier_stat_t;
+
+typedef struct pipe_stat {
+  int bytes_written; // total bytes written into the pipe
+  int bytes_read;    // total bytes read out of the pipe
+  int read_blocks;   // times a reader blocked on an empty pipe
+  int write_blocks;  // times a writer blocked on a full pipe
+  int high_water;    // max bytes ever buffered at once
+  int capacity;      // current max bytes the pipe may buffer
+  int wasted_wakeups; // woken readers/writers that found nothing to do and blocked again
+  int handoff_bytes;  // bytes copied straight from a writer to a waiting reader, skipping the buffer
+  int flipped_bytes;  // bytes passed as whole frames from a writer's pages, not copied at all
+} pipe_stat_t;
+
+typedef struct ipc_stat {
+  int id;
+  int type;       // IPC_PIPE, IPC_LOCK, IPC_CVAR, IPC_RWLOCK, IPC_SEM or IPC_BARRIER
+  int contention; // a type-independent "how contended" figure for ranking
+  union {
+    lock_stat_t lock;
+    cvar_stat_t cvar;
+    pipe_stat_t pipe;
+    rwlock_stat_t rwlock;
+    sem_stat_t sem;
+    barrier_stat_t barrier;
+  } u;
+} ipc_stat_t;
+
+/////////////// Physical memory profiling
+
+// what a physical frame is being used for
+#define FRAME_FREE 0
+#define FRAME_KTEXT 1  // kernel text
+#define FRAME_KHEAP 2  // kernel data and heap (pcbs, page tables, buffers...)
+#define FRAME_KSTACK 3 // a process' kernel stack
+#define FRAME_UTEXT 4  // user text
+#define FRAME_UDATA 5  // user data and bss
+#define FRAME_UHEAP 6  // user heap (above the data, up to brk)
+#define FRAME_USTACK 7 // user stack
+#define FRAME_SHM 8    // shared memory segments (owned by the kernel, mapped by anyone attached)
+#define NUM_FRAME_PURPOSES 9
+
+#define KERNEL_OWNER (-1) // owner "pid" of frames belonging to the kernel itself
+#define MEMINFO_MAX_OWNERS 32
+
+typedef struct mem_owner {
+  int pid;                          // KERNEL_OWNER for the kernel itself
+  int frames[NUM_FRAME_PURPOSES];   // # of frames held, by purpose
+} mem_owner_t;
+
+typedef struct mem_info {
+  int total_frames;
+  int free_frames;
+  int largest_free_run;             // longest run of consecutive free frames
+  int alloc_failures;               // frame allocations refused for lack of memory
+  int frames[NUM_FRAME_PURPOSES];   // # of frames in use system-wide, by purpose
+  int num_owners;                   // # of distinct owners (may be > MEMINFO_MAX_OWNERS)
+  mem_owner_t owners[MEMINFO_MAX_OWNERS];
+} mem_info_t;
+
+/////////////// Kernel heap profiling
+
+// kernel allocation sites
+#define KH_OTHER 0
+#define KH_PCB 1       // process control blocks
+#define KH_USER_PT 2   // user_pt_t region 1 page tables
+#define KH_KSTACK_PT 3 // kernel stack page tables
+#define KH_LIST 4      // linked lists
+#define KH_NODE 5      // linked list nodes
+#define KH_BUFFER 6    // pipe/terminal buffers
+#define KH_IPC 7       // pipe/lock/cvar structs
+#define KH_TTY 8       // terminal bookkeeping
+#define KH_FRAMES 9    // physical frame bookkeeping
+#define KH_LOAD 10     // LoadProgram argument copies
+#define NUM_KH_SITES 11
+
+typedef struct kheap_site {
+  int allocs;       // total allocations ever made
+  int live_objects; // allocations not yet freed
+  int live_bytes;   // bytes not yet freed
+  int peak_bytes;   // max live_bytes ever
+} kheap_site_t;
+
+typedef struct kheap_info {
+  int heap_bytes;     // current kernel heap size (brk - original brk)
+  int headroom_bytes; // bytes the kernel brk can still grow by
+  int profiled;       // 1 if the kernel was built with KHEAP_PROFILE, i.e. sites is valid
+  kheap_site_t sites[NUM_KH_SITES];
+} kheap_info_t;
+
+#endif // __YCUSTOM_H
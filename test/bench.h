@@ -0,0 +1,32 @@
+/* Erich Woo & Boxian Wang
+ * 5 December 2020
+ * Shared helpers for the benchmark programs (test/bench_*.c)
+ *
+ * Every benchmark result is a single TracePrintf line of the form
+ *   BENCH <name> <param>=<value> ops=<n> ticks=<t>
+ * so results can be pulled out of the TRACE file with grep '^BENCH'
+ */
+
+#ifndef __BENCH_H
+#define __BENCH_H
+
+#include "yuserx.h"
+
+/* Reports one benchmark result in the machine-parseable format above
+ *
+ * @param name the benchmark name
+ * @param param the name of the parameter varied, e.g. "bufsize"
+ * @param value the value of that parameter
+ * @param ops the # of operations timed
+ * @param ticks the # of clock-ticks they took
+ */
+static inline void bench_report(char *name, char *param, int value, int ops, int ticks) {
+  TracePrintf(0, "BENCH %s %s=%d ops=%d ticks=%d\n", name, param, value, ops, ticks);
+}
+
+/* Returns argv[i] as an int, or def if not given */
+static inline int bench_arg(int argc, char *argv[], int i, int def) {
+  return argc > i ? atoi(argv[i]) : def;
+}
+
+#endif // __BENCH_H
@@ -0,0 +1,71 @@
+/* Erich Woo & Boxian Wang
+ * 11 December 2020
+ * Benchmark: N processes going through a barrier round after round, with the
+ * native BarrierWait vs. one built out of a lock, a cvar and a shared counter
+ *
+ * usage: bench_barrier [procs] [rounds]
+ */
+
+#include "bench.h"
+
+typedef struct shared { // the lock + cvar barrier's state, in shared memory
+  int arrived;
+  int round;
+} shared_t;
+
+// the classic barrier: the last to arrive bumps the round and broadcasts
+void lockcvar_wait(shared_t *s, int n, int lock_id, int cvar_id) {
+  Acquire(lock_id);
+  int round = s->round;
+  if (++s->arrived == n) {
+    s->arrived = 0;
+    s->round++;
+    CvarBroadcast(cvar_id);
+  } else {
+    while (s->round == round) CvarWait(cvar_id, lock_id);
+  }
+  Release(lock_id);
+}
+
+// runs rounds of the given barrier in n processes, returning the parent's ticks
+int run(int native, int n, int rounds, shared_t *s) {
+  int barrier_id, lock_id, cvar_id;
+  if (native ? BarrierInit(&barrier_id, n) == ERROR :
+      LockInit(&lock_id) == ERROR || CvarInit(&cvar_id) == ERROR) Exit(-1);
+  s->arrived = s->round = 0;
+  for (int p = 1; p < n; p++) {
+    if (Fork() == 0) {
+      for (int r = 0; r < rounds; r++) {
+	if (native) BarrierWait(barrier_id);
+	else lockcvar_wait(s, n, lock_id, cvar_id);
+      }
+      Exit(0);
+    }
+  }
+  int start = GetTicks();
+  for (int r = 0; r < rounds; r++) {
+    if (native) BarrierWait(barrier_id);
+    else lockcvar_wait(s, n, lock_id, cvar_id);
+  }
+  int ticks = GetTicks() - start;
+  for (int p = 1; p < n; p++) Wait(NULL);
+  if (native) Reclaim(barrier_id);
+  else {
+    Reclaim(cvar_id);
+    Reclaim(lock_id);
+  }
+  return ticks;
+}
+
+int main(int argc, char *argv[]) {
+  int n = bench_arg(argc, argv, 1, 8);
+  int rounds = bench_arg(argc, argv, 2, 50);
+  int shm_id = ShmCreate(sizeof(shared_t));
+  shared_t *s = ShmAttach(shm_id, NULL); // children inherit it
+  if (s == (void *) ERROR) Exit(-1);
+  bench_report("barrier_native", "procs", n, rounds, run(1, n, rounds, s));
+  bench_report("barrier_lockcvar", "procs", n, rounds, run(0, n, rounds, s));
+  ShmDetach(s);
+  Reclaim(shm_id);
+  Exit(0);
+}
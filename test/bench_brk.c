@@ -0,0 +1,22 @@
+/* Erich Woo & Boxian Wang
+ * 5 December 2020
+ * Benchmark: Brk grow/shrink churn
+ *
+ * usage: bench_brk [n] [pages]
+ */
+
+#include "bench.h"
+
+int main(int argc, char *argv[]) {
+  int n = bench_arg(argc, argv, 1, 200);
+  int pages = bench_arg(argc, argv, 2, 8);
+  char *base = (char *) malloc(PAGESIZE) + PAGESIZE; // safely above malloc's own data
+
+  int start = GetTicks();
+  for (int i = 0; i < n; i++) {
+    if (Brk(base + pages * PAGESIZE) == ERROR) Exit(-1);
+    Brk(base);
+  }
+  bench_report("brk_churn", "pages", pages, n, GetTicks() - start);
+  Exit(0);
+}
@@ -0,0 +1,52 @@
+/* Erich Woo & Boxian Wang
+ * 5 December 2020
+ * Benchmark: cvar broadcast fan-out to N waiting processes
+ *
+ * Each round, every child reports "about to wait" through a pipe while
+ * holding the lock, so once the parent gets the lock all of them are waiting.
+ * The parent broadcasts and times until every child reports back.
+ *
+ * usage: bench_cvar [waiters] [rounds]
+ */
+
+#include "bench.h"
+
+int main(int argc, char *argv[]) {
+  int waiters = bench_arg(argc, argv, 1, 8);
+  int rounds = bench_arg(argc, argv, 2, 20);
+  int lock_id, cvar_id, ready_pipe, done_pipe;
+  char c = 'x';
+  if (LockInit(&lock_id) == ERROR || CvarInit(&cvar_id) == ERROR ||
+      PipeInit(&ready_pipe) == ERROR || PipeInit(&done_pipe) == ERROR) Exit(-1);
+
+  for (int w = 0; w < waiters; w++) {
+    if (Fork() == 0) {
+      for (int r = 0; r < rounds; r++) {
+	Acquire(lock_id);
+	PipeWrite(ready_pipe, &c, 1);
+	CvarWait(cvar_id, lock_id);
+	Release(lock_id);
+	PipeWrite(done_pipe, &c, 1);
+      }
+      Exit(0);
+    }
+  }
+
+  int ticks = 0;
+  for (int r = 0; r < rounds; r++) {
+    for (int got = 0; got < waiters; got++) PipeRead(ready_pipe, &c, 1);
+    Acquire(lock_id); // everyone is in CvarWait now
+    int start = GetTicks();
+    CvarBroadcast(cvar_id);
+    Release(lock_id);
+    for (int got = 0; got < waiters; got++) PipeRead(done_pipe, &c, 1);
+    ticks += GetTicks() - start;
+  }
+  for (int w = 0; w < waiters; w++) Wait(NULL);
+  bench_report("cvar_broadcast", "waiters", waiters, rounds, ticks);
+  ipc_stat_t st;
+  if (IpcStat(cvar_id, &st) == 0) TracePrintf(0, "  cvar %d spurious=%d\n", cvar_id, st.u.cvar.spurious);
+  if (IpcStat(lock_id, &st) == 0) TracePrintf(0, "  lock %d wakeups=%d wasted_wakeups=%d\n", lock_id,
+					      st.u.lock.wakeups, st.u.lock.wasted_wakeups);
+  Exit(0);
+}
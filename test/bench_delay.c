@@ -0,0 +1,42 @@
+/* Erich Woo & Boxian Wang
+ * 5 December 2020
+ * Benchmark: Delay timer accuracy with N concurrent sleepers
+ *
+ * Each sleeper Delays for d ticks, rounds times, and sends its total
+ * overshoot (measured ticks - requested ticks) back through a pipe.
+ *
+ * usage: bench_delay [sleepers] [ticks] [rounds]
+ */
+
+#include "bench.h"
+
+int main(int argc, char *argv[]) {
+  int sleepers = bench_arg(argc, argv, 1, 8);
+  int d = bench_arg(argc, argv, 2, 3);
+  int rounds = bench_arg(argc, argv, 3, 10);
+  int pipe_id;
+  if (PipeInit(&pipe_id) == ERROR) Exit(-1);
+
+  for (int s = 0; s < sleepers; s++) {
+    if (Fork() == 0) {
+      int overshoot = 0;
+      for (int r = 0; r < rounds; r++) {
+	int start = GetTicks();
+	Delay(d);
+	overshoot += GetTicks() - start - d;
+      }
+      PipeWrite(pipe_id, &overshoot, sizeof(int));
+      Exit(0);
+    }
+  }
+
+  int total = 0, overshoot;
+  for (int s = 0; s < sleepers; s++) {
+    for (int got = 0; got < sizeof(int); ) got += PipeRead(pipe_id, (char *) &overshoot + got, sizeof(int) - got);
+    total += overshoot;
+  }
+  for (int s = 0; s < sleepers; s++) Wait(NULL);
+  // ticks here is the total overshoot over all sleeps: 0 means perfectly on time
+  bench_report("delay_overshoot", "sleepers", sleepers, sleepers * rounds, total);
+  Exit(0);
+}
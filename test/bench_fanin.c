@@ -0,0 +1,43 @@
+/* Erich Woo & Boxian Wang
+ * 7 December 2020
+ * Benchmark: many writers fanning in to one reader over a single pipe
+ *
+ * usage: bench_fanin [msgs_per_writer] [msg_size]
+ */
+
+#include "bench.h"
+
+#define MAX_MSG 1024
+
+int writers[] = {1, 2, 4, 8, 16};
+char msg[MAX_MSG];
+
+int main(int argc, char *argv[]) {
+  int msgs = bench_arg(argc, argv, 1, 64);
+  int size = bench_arg(argc, argv, 2, 64);
+  if (size > MAX_MSG) size = MAX_MSG;
+
+  for (int w = 0; w < sizeof(writers) / sizeof(int); w++) {
+    int n = writers[w], pipe_id;
+    if (PipeInit(&pipe_id) == ERROR) Exit(-1);
+    int start = GetTicks();
+    for (int i = 0; i < n; i++) {
+      if (Fork() == 0) {
+	for (int m = 0; m < msgs; m++) PipeWrite(pipe_id, msg, size);
+	Exit(0);
+      }
+    }
+    for (int got = 0; got < n * msgs * size; ) {
+      int r = PipeRead(pipe_id, msg, size);
+      if (r <= 0) Exit(-1);
+      got += r;
+    }
+    for (int i = 0; i < n; i++) Wait(NULL);
+    bench_report("pipe_fanin", "writers", n, n * msgs, GetTicks() - start);
+    ipc_stat_t st;
+    if (IpcStat(pipe_id, &st) == 0)
+      TracePrintf(0, "  pipe %d wasted_wakeups=%d\n", pipe_id, st.u.pipe.wasted_wakeups);
+    Reclaim(pipe_id);
+  }
+  Exit(0);
+}
@@ -0,0 +1,40 @@
+/* Erich Woo & Boxian Wang
+ * 5 December 2020
+ * Benchmark: fork+exit+wait, fork+exec+wait and spawn+wait rates
+ *
+ * usage: bench_fork [n]
+ */
+
+#include "bench.h"
+
+int main(int argc, char *argv[]) {
+  if (argc > 1 && strcmp(argv[1], "child") == 0) Exit(0); // the exec'd child
+
+  int n = bench_arg(argc, argv, 1, 50);
+  char *args[] = {"test/bench_fork", "child", NULL};
+
+  int start = GetTicks();
+  for (int i = 0; i < n; i++) {
+    if (Fork() == 0) Exit(0);
+    Wait(NULL);
+  }
+  bench_report("fork_exit", "n", n, n, GetTicks() - start);
+
+  start = GetTicks();
+  for (int i = 0; i < n; i++) {
+    if (Fork() == 0) {
+      Exec(args[0], args);
+      Exit(-1);
+    }
+    Wait(NULL);
+  }
+  bench_report("fork_exec", "n", n, n, GetTicks() - start);
+
+  start = GetTicks();
+  for (int i = 0; i < n; i++) {
+    Spawn(args[0], args);
+    Wait(NULL);
+  }
+  bench_report("spawn", "n", n, n, GetTicks() - start);
+  Exit(0);
+}
@@ -0,0 +1,87 @@
+/* Erich Woo & Boxian Wang
+ * 5 December 2020
+ * Benchmark: lock acquire/release, uncontended and ping-ponged between two processes
+ * (in both the default mesa mode and the handoff mode),
+ * and the same for a futex-based ulock_t in shared memory for comparison
+ *
+ * In the ping-pongs each process holds the lock across a Pause(), so the other
+ * one runs into it held and blocks every round, rather than only when a clock
+ * tick happens to land between Acquire and Release
+ *
+ * usage: bench_lock [n] [rounds]
+ */
+
+#include "bench.h"
+#include "ulock.h"
+
+// n rounds of taking the lock and yielding with it held
+void lock_rounds(int lock_id, int n) {
+  for (int i = 0; i < n; i++) {
+    Acquire(lock_id);
+    Pause(); // the other process runs into it
+    Release(lock_id);
+  }
+}
+
+void ulock_rounds(ulock_t *l, int n) {
+  for (int i = 0; i < n; i++) {
+    ulock_acquire(l);
+    Pause();
+    ulock_release(l);
+  }
+}
+
+int main(int argc, char *argv[]) {
+  int n = bench_arg(argc, argv, 1, 1000);
+  int rounds = bench_arg(argc, argv, 2, 100); // ping-pong rounds per process, each one a Pause()
+  int lock_id;
+  if (LockInit(&lock_id) == ERROR) Exit(-1);
+
+  int start = GetTicks();
+  for (int i = 0; i < n; i++) {
+    Acquire(lock_id);
+    Release(lock_id);
+  }
+  bench_report("lock_uncontended", "n", n, n, GetTicks() - start);
+
+  ulock_t ul;
+  ulock_init(&ul);
+  start = GetTicks();
+  for (int i = 0; i < n; i++) {
+    ulock_acquire(&ul);
+    ulock_release(&ul);
+  }
+  bench_report("ulock_uncontended", "n", n, n, GetTicks() - start);
+
+  char *pingpongs[] = {"lock_pingpong", "lock_handoff_pingpong"}; // by LOCK_MESA, LOCK_HANDOFF
+  for (int mode = LOCK_MESA; mode <= LOCK_HANDOFF; mode++) {
+    if (LockInit(&lock_id) == ERROR || LockSetMode(lock_id, mode) == ERROR) Exit(-1);
+    start = GetTicks();
+    if (Fork() == 0) {
+      lock_rounds(lock_id, rounds);
+      Exit(0);
+    }
+    lock_rounds(lock_id, rounds);
+    Wait(NULL);
+    bench_report(pingpongs[mode], "procs", 2, 2 * rounds, GetTicks() - start);
+    ipc_stat_t st;
+    if (IpcStat(lock_id, &st) == 0)
+      TracePrintf(0, "  lock %d wakeups=%d wasted_wakeups=%d\n", lock_id, st.u.lock.wakeups, st.u.lock.wasted_wakeups);
+    Reclaim(lock_id);
+  }
+
+  int shm_id = ShmCreate(sizeof(ulock_t));
+  ulock_t *shared = ShmAttach(shm_id, NULL);
+  if (shared == (void *) ERROR) Exit(-1);
+  ulock_init(shared);
+  start = GetTicks();
+  if (Fork() == 0) { // inherits the attachment
+    ulock_rounds(shared, rounds);
+    Exit(0);
+  }
+  ulock_rounds(shared, rounds);
+  Wait(NULL);
+  bench_report("ulock_pingpong", "procs", 2, 2 * rounds, GetTicks() - start);
+  Reclaim(shm_id);
+  Exit(0);
+}
@@ -0,0 +1,62 @@
+/* Erich Woo & Boxian Wang
+ * 5 December 2020
+ * Benchmark: pipe throughput from one writer to one reader, across chunk sizes,
+ * with default pipes and with PIPE_MAX_CAPACITY pipes, then page-aligned
+ * whole-page transfers (which flip frames instead of copying)
+ *
+ * usage: bench_pipe [total_bytes]
+ */
+
+#include "bench.h"
+
+#define MAX_CHUNK 4096
+#define FLIP_PAGES 4
+
+int sizes[] = {16, 64, 256, 1024, 4096};
+char chunk[MAX_CHUNK];
+char pages[FLIP_PAGES * PAGESIZE] __attribute__((aligned(PAGESIZE)));
+
+int main(int argc, char *argv[]) {
+  int total = bench_arg(argc, argv, 1, 65536);
+
+  for (int i = 0; i < 2 * sizeof(sizes) / sizeof(int); i++) {
+    int size = sizes[i % (sizeof(sizes) / sizeof(int))], pipe_id;
+    int maxcap = i >= sizeof(sizes) / sizeof(int);
+    if ((maxcap ? PipeInitCap(&pipe_id, PIPE_MAX_CAPACITY) : PipeInit(&pipe_id)) == ERROR) Exit(-1);
+    int start = GetTicks();
+    if (Fork() == 0) { // reader
+      for (int got = 0; got < total; ) {
+	int r = PipeRead(pipe_id, chunk, size);
+	if (r <= 0) Exit(-1);
+	got += r;
+      }
+      Exit(0);
+    }
+    for (int sent = 0; sent < total; sent += size) PipeWrite(pipe_id, chunk, size);
+    Wait(NULL);
+    bench_report(maxcap ? "pipe_throughput_maxcap" : "pipe_throughput", "bufsize", size, total, GetTicks() - start);
+    Reclaim(pipe_id);
+  }
+
+  for (int n = 1; n <= FLIP_PAGES; n *= 2) {
+    int size = n * PAGESIZE, pipe_id, rounds = total / size > 0 ? total / size : 1;
+    if (PipeInit(&pipe_id) == ERROR) Exit(-1);
+    int start = GetTicks();
+    if (Fork() == 0) { // reader
+      for (int got = 0; got < rounds * size; ) {
+	int r = PipeRead(pipe_id, pages, size);
+	if (r <= 0) Exit(-1);
+	got += r;
+      }
+      Exit(0);
+    }
+    for (int i = 0; i < rounds; i++) {
+      pages[0] = i; // touch it, so each round breaks the last round's sharing
+      PipeWrite(pipe_id, pages, size);
+    }
+    Wait(NULL);
+    bench_report("pipe_flip", "pages", n, rounds * size, GetTicks() - start);
+    Reclaim(pipe_id);
+  }
+  Exit(0);
+}
@@ -0,0 +1,75 @@
+/* Erich Woo & Boxian Wang
+ * 9 December 2020
+ * Load generator: drives many test/shell sessions over pseudo-terminals with
+ * scripted input, timing command round trips (typing a line -> next prompt)
+ *
+ * usage: bench_pty [rounds] [max_shells]
+ */
+
+#include "bench.h"
+
+#define MAX_SHELLS 32
+#define PROMPT "yalnix> "
+
+int shells[] = {1, 4, 16, 32};
+char *script[] = {"\n", "test/bench_pty noop\n"}; // an empty line, then a command the shell spawns
+char *names[] = {"pty_line", "pty_spawn"};
+
+// reads what the shell on pty writes until its prompt comes by
+int await_prompt(int pty) {
+  char buf[256];
+  int matched = 0, plen = strlen(PROMPT);
+  while (1) {
+    int n = PtyRead(pty, buf, sizeof(buf));
+    if (n <= 0) return ERROR;
+    for (int i = 0; i < n; i++) {
+      if (buf[i] == PROMPT[matched]) matched++;
+      else matched = (buf[i] == PROMPT[0]);
+      if (matched == plen) return 0; // the shell is reading again
+    }
+  }
+}
+
+// writes n in decimal to buf
+void itoa10(int n, char *buf) {
+  char tmp[12];
+  int len = 0;
+  do tmp[len++] = '0' + n % 10; while ((n /= 10) > 0);
+  while (len > 0) *buf++ = tmp[--len];
+  *buf = '\0';
+}
+
+int main(int argc, char *argv[]) {
+  if (argc > 1 && strcmp(argv[1], "noop") == 0) Exit(0); // the command the shells spawn
+  int rounds = bench_arg(argc, argv, 1, 8);
+  int max = bench_arg(argc, argv, 2, 16);
+  if (max > MAX_SHELLS) max = MAX_SHELLS;
+  int ptys[MAX_SHELLS];
+  char ids[MAX_SHELLS][12];
+
+  for (int s = 0; s < sizeof(shells) / sizeof(int) && shells[s] <= max; s++) {
+    int n = shells[s];
+    for (int i = 0; i < n; i++) {
+      if (PtyOpen(&ptys[i]) == ERROR) Exit(-1);
+      itoa10(ptys[i], ids[i]);
+      char *args[] = {"test/shell", ids[i], NULL};
+      if (Spawn(args[0], args) == ERROR) Exit(-1);
+    }
+    for (int i = 0; i < n; i++) if (await_prompt(ptys[i]) == ERROR) Exit(-1);
+
+    for (int c = 0; c < sizeof(script) / sizeof(char *); c++) {
+      int len = strlen(script[c]);
+      int start = GetTicks();
+      for (int r = 0; r < rounds; r++) {
+	for (int i = 0; i < n; i++) PtyWrite(ptys[i], script[c], len); // all shells busy at once
+	for (int i = 0; i < n; i++) if (await_prompt(ptys[i]) == ERROR) Exit(-1);
+      }
+      bench_report(names[c], "shells", n, n * rounds, GetTicks() - start);
+    }
+
+    for (int i = 0; i < n; i++) PtyWrite(ptys[i], "exit\n", 5);
+    for (int i = 0; i < n; i++) Wait(NULL);
+    for (int i = 0; i < n; i++) PtyClose(ptys[i]);
+  }
+  Exit(0);
+}
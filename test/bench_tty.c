@@ -0,0 +1,27 @@
+/* Erich Woo & Boxian Wang
+ * 5 December 2020
+ * Benchmark: TtyWrite throughput across write sizes
+ *
+ * usage: bench_tty [tty_id] [total_bytes]
+ */
+
+#include "bench.h"
+
+#define MAX_CHUNK 4096
+
+int sizes[] = {16, 128, 1024, 4096};
+char chunk[MAX_CHUNK];
+
+int main(int argc, char *argv[]) {
+  int tty = bench_arg(argc, argv, 1, 1);
+  int total = bench_arg(argc, argv, 2, 16384);
+  for (int i = 0; i < MAX_CHUNK; i++) chunk[i] = (i % 64 == 63) ? '\n' : 'a' + i % 26;
+
+  for (int s = 0; s < sizeof(sizes) / sizeof(int); s++) {
+    int size = sizes[s];
+    int start = GetTicks();
+    for (int sent = 0; sent < total; sent += size) TtyWrite(tty, chunk, size);
+    bench_report("tty_write", "size", size, total, GetTicks() - start);
+  }
+  Exit(0);
+}
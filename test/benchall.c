@@ -0,0 +1,22 @@
+/* Erich Woo & Boxian Wang
+ * 5 December 2020
+ * Runs every benchmark in turn with its default arguments
+ *
+ * usage: ./yalnix -x test/benchall    (then grep '^BENCH' TRACE)
+ */
+
+#include "bench.h"
+
+char *benches[] = {"test/bench_fork", "test/bench_pipe", "test/bench_fanin", "test/bench_lock", "test/bench_cvar",
+		   "test/bench_brk", "test/bench_delay", "test/bench_tty", "test/bench_pty", "test/bench_barrier", NULL};
+
+int main(int argc, char *argv[]) {
+  for (int b = 0; benches[b] != NULL; b++) {
+    char *args[] = {benches[b], NULL};
+    int status;
+    if (Spawn(args[0], args) == ERROR) status = ERROR;
+    else Wait(&status);
+    if (status != 0) TracePrintf(0, "BENCH_FAILED %s status=%d\n", benches[b], status);
+  }
+  Exit(0);
+}
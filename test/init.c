@@ -1,4 +1,4 @@
-#include <yuser.h>
+#include "yuserx.h"
 
 #define CONSOLE 0
 #define MAX_TERMINAL 3
@@ -12,16 +12,9 @@ int ForkChild(char * cmd_argv[])
 {
   int pid;
 
-  switch (pid = Fork()) {
-  case 0:
-    Exec(cmd_argv[0], cmd_argv);
+  if ((pid = Spawn(cmd_argv[0], cmd_argv)) == ERROR)
     return NOEXEC;
-  case ERROR:
-    return NOFORK;
-  default:
-    return pid;
-    break;
-  }
+  return pid;
 }
 
 int
@@ -71,7 +64,7 @@ main(int argc, char *argv[])
   }
 
 
-  if (pids[CONSOLE] == -1) {
+  if (pids[CONSOLE] < 0) {
     TtyPrintf(CONSOLE, "Cannot start Console monitor, halting...\n");
     Exit(-1);
   }
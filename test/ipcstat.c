@@ -0,0 +1,62 @@
+/* Erich Woo & Boxian Wang
+ * 2 December 2020
+ * ipcstat: prints the most contended pipes, locks, and cvars
+ *
+ * usage: ipcstat [top_n] [tty_id]
+ */
+
+#include "yuserx.h"
+
+#define MAX_IPC 128
+
+ipc_stat_t stats[MAX_IPC];
+
+int main(int argc, char *argv[]) {
+  int top = argc > 1 ? atoi(argv[1]) : 10;
+  int tty = argc > 2 ? atoi(argv[2]) : 0;
+  int total = IpcList(stats, MAX_IPC);
+  if (total == ERROR) {
+    TtyPrintf(tty, "ipcstat: IpcList failed\n");
+    Exit(-1);
+  }
+  int n = total < MAX_IPC ? total : MAX_IPC;
+
+  // selection sort by contention, most contended first
+  for (int i = 0; i < n; i++) {
+    int max = i;
+    for (int j = i + 1; j < n; j++)
+      if (stats[j].contention > stats[max].contention) max = j;
+    ipc_stat_t tmp = stats[i];
+    stats[i] = stats[max];
+    stats[max] = tmp;
+  }
+
+  TtyPrintf(tty, "%d ipc objects alive, top %d by contention:\n", total, top < n ? top : n);
+  for (int i = 0; i < n && i < top; i++) {
+    ipc_stat_t *s = &stats[i];
+    if (s->type == IPC_LOCK) {
+      TtyPrintf(tty, "lock %d: acquires %d contended %d blocked_ticks %d max_blocked %d wakeups %d wasted %d timeouts %d\n", s->id,
+		s->u.lock.acquires, s->u.lock.contended, s->u.lock.blocked_ticks, s->u.lock.max_blocked_ticks,
+		s->u.lock.wakeups, s->u.lock.wasted_wakeups, s->u.lock.timeouts);
+    } else if (s->type == IPC_RWLOCK) {
+      TtyPrintf(tty, "rwlock %d: reads %d writes %d read_blocks %d write_blocks %d batches %d max_batch %d\n", s->id,
+		s->u.rwlock.read_acquires, s->u.rwlock.write_acquires, s->u.rwlock.read_blocks,
+		s->u.rwlock.write_blocks, s->u.rwlock.batches, s->u.rwlock.max_batch);
+    } else if (s->type == IPC_SEM) {
+      TtyPrintf(tty, "sem %d: count %d downs %d ups %d blocks %d\n", s->id,
+		s->u.sem.count, s->u.sem.downs, s->u.sem.ups, s->u.sem.blocks);
+    } else if (s->type == IPC_BARRIER) {
+      TtyPrintf(tty, "barrier %d: n %d waits %d releases %d\n", s->id,
+		s->u.barrier.n, s->u.barrier.waits, s->u.barrier.releases);
+    } else if (s->type == IPC_CVAR) {
+      TtyPrintf(tty, "cvar %d: waits %d signals %d broadcasts %d spurious %d timeouts %d\n", s->id,
+		s->u.cvar.waits, s->u.cvar.signals, s->u.cvar.broadcasts, s->u.cvar.spurious, s->u.cvar.timeouts);
+    } else {
+      TtyPrintf(tty, "pipe %d: written %d read %d read_blocks %d write_blocks %d wasted_wakeups %d handoff %d flipped %d high_water %d/%d\n",
+		s->id, s->u.pipe.bytes_written, s->u.pipe.bytes_read, s->u.pipe.read_blocks,
+		s->u.pipe.write_blocks, s->u.pipe.wasted_wakeups, s->u.pipe.handoff_bytes,
+		s->u.pipe.flipped_bytes, s->u.pipe.high_water, s->u.pipe.capacity);
+    }
+  }
+  Exit(0);
+}
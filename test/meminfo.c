@@ -0,0 +1,57 @@
+/* Erich Woo & Boxian Wang
+ * 3 December 2020
+ * meminfo: prints physical frame usage by pid and purpose, and kernel heap usage
+ *
+ * usage: meminfo [tty_id]
+ */
+
+#include "yuserx.h"
+
+char *purposes[NUM_FRAME_PURPOSES] = {"free", "ktext", "kheap", "kstack", "utext", "udata", "uheap", "ustack", "shm"};
+
+char *sites[NUM_KH_SITES] = {"other", "pcb", "user_pt", "kstack_pt", "list", "node",
+			     "buffer", "ipc", "tty", "frames", "load"};
+
+mem_info_t info;
+kheap_info_t kheap;
+
+int main(int argc, char *argv[]) {
+  int tty = argc > 1 ? atoi(argv[1]) : 0;
+  if (MemInfo(&info) == ERROR) {
+    TtyPrintf(tty, "meminfo: MemInfo failed\n");
+    Exit(-1);
+  }
+
+  TtyPrintf(tty, "frames: %d total, %d free, largest free run %d, %d failed allocations\n",
+	    info.total_frames, info.free_frames, info.largest_free_run, info.alloc_failures);
+  for (int p = 1; p < NUM_FRAME_PURPOSES; p++)
+    TtyPrintf(tty, "  %-6s %d\n", purposes[p], info.frames[p]);
+
+  int shown = info.num_owners < MEMINFO_MAX_OWNERS ? info.num_owners : MEMINFO_MAX_OWNERS;
+  TtyPrintf(tty, "by owner (%d owners):\n", info.num_owners);
+  for (int o = 0; o < shown; o++) {
+    mem_owner_t *owner = &info.owners[o];
+    if (owner->pid == KERNEL_OWNER) TtyPrintf(tty, "  kernel:");
+    else TtyPrintf(tty, "  pid %d:", owner->pid);
+    for (int p = 1; p < NUM_FRAME_PURPOSES; p++)
+      if (owner->frames[p] > 0) TtyPrintf(tty, " %s %d", purposes[p], owner->frames[p]);
+    TtyPrintf(tty, "\n");
+  }
+
+  if (KHeapInfo(&kheap) == ERROR) {
+    TtyPrintf(tty, "meminfo: KHeapInfo failed\n");
+    Exit(-1);
+  }
+  TtyPrintf(tty, "kernel heap: %d bytes, %d bytes headroom\n", kheap.heap_bytes, kheap.headroom_bytes);
+  if (!kheap.profiled) {
+    TtyPrintf(tty, "  (build the kernel with KHEAP_PROFILE=1 for per-site usage)\n");
+    Exit(0);
+  }
+  for (int s = 0; s < NUM_KH_SITES; s++) {
+    kheap_site_t *site = &kheap.sites[s];
+    if (site->allocs == 0) continue;
+    TtyPrintf(tty, "  %-9s live %d bytes / %d objects, peak %d bytes, %d allocs\n", sites[s],
+	      site->live_bytes, site->live_objects, site->peak_bytes, site->allocs);
+  }
+  Exit(0);
+}
@@ -1,4 +1,5 @@
-#include "yuser.h"
+#include "yuserx.h"
+#include "ulock.h"
 
 char* global_var = "abcdef";
 
@@ -289,6 +290,234 @@ int main(int argc, char* argv[]) {
     TtyPrintf(0, "Test complete. Parent exiting now\n");
     Exit(0);
   }
+  //KERNEL SPAWN and WAITPID
+  else if (strcmp(argv[1], "8") == 0) {
+    TracePrintf(1, "Testing Spawn/WaitPid\n");
+    TracePrintf(1, "WaitPid on a non-child should be ERROR: %d\n", WaitPid(GetPid(), NULL, 0));
+    char* args[3] = {"test/myinit", "0", NULL};
+    int cid1 = Spawn(args[0], args);
+    int cid2 = Fork();
+    if (cid2 == 0) {
+      Delay(5);
+      Exit(7);
+    }
+    TracePrintf(1, "Spawn of a missing program should be ERROR: %d\n", Spawn("test/nonexistent", args));
+    int status;
+    TracePrintf(1, "WAIT_NOHANG on the Delaying child %d should be 0: %d\n", cid2, WaitPid(cid2, &status, WAIT_NOHANG));
+    TracePrintf(1, "Collected child %d (should be %d) with status %d (should be 7)\n",
+		WaitPid(cid2, &status, 0), cid2, status);
+    TracePrintf(1, "Collected child %d (should be %d) with status %d (should be 5)\n",
+		WaitPid(WAIT_ANY, &status, 0), cid1, status);
+    TracePrintf(1, "No children left, should be ERROR: %d\n", WaitPid(WAIT_ANY, NULL, WAIT_NOHANG));
+
+    Exit(0);
+  }
+  //KERNEL POLL
+  else if (strcmp(argv[1], "9") == 0) {
+    TracePrintf(1, "Testing Poll\n");
+    int pipes[2];
+    PipeInit(&pipes[0]);
+    PipeInit(&pipes[1]);
+    poll_entry_t fds[2] = {{pipes[0], POLL_PIPE, POLL_IN, 0}, {pipes[1], POLL_PIPE, POLL_IN, 0}};
+    TracePrintf(1, "Nothing written yet, Poll with timeout 3 should be 0: %d\n", Poll(fds, 2, 3));
+    fds[1].kind = 7;
+    TracePrintf(1, "Polling a bad kind should be ERROR: %d\n", Poll(fds, 2, 0));
+    fds[1].kind = POLL_PIPE;
+    // each child writes to its own pipe, at different times
+    for (int i = 0; i < 2; i++) {
+      if (Fork() == 0) {
+	Delay(5 * (i + 1));
+	PipeWrite(pipes[i], "hello", 6);
+	Exit(0);
+      }
+    }
+    char buf[6];
+    for (int got = 0; got < 2; ) {
+      int ready = Poll(fds, 2, POLL_FOREVER);
+      TracePrintf(1, "Poll returned %d ready\n", ready);
+      for (int i = 0; i < 2; i++) {
+	if (fds[i].revents & POLL_IN) {
+	  PipeRead(pipes[i], buf, 6);
+	  TracePrintf(1, "Read '%s' from pipe %d (child %d)\n", buf, pipes[i], i + 1);
+	  got++;
+	}
+      }
+    }
+    Wait(NULL);
+    Wait(NULL);
+    Exit(0);
+  }
+  //NONBLOCKING I/O
+  else if (strcmp(argv[1], "10") == 0) {
+    TracePrintf(1, "Testing nonblocking pipe I/O\n");
+    int pipe_id;
+    char buf[PIPE_BUFFER_LEN + 10];
+    PipeInit(&pipe_id);
+    TracePrintf(1, "Reading an empty pipe should be WOULD_BLOCK (%d): %d\n", WOULD_BLOCK, PipeReadNB(pipe_id, buf, 10));
+    TracePrintf(1, "Overfilling should write only %d: %d\n", PIPE_BUFFER_LEN, PipeWriteNB(pipe_id, buf, PIPE_BUFFER_LEN + 10));
+    TracePrintf(1, "Writing a full pipe should be WOULD_BLOCK (%d): %d\n", WOULD_BLOCK, PipeWriteNB(pipe_id, buf, 1));
+    TracePrintf(1, "Reading it back should read 10: %d\n", PipeReadNB(pipe_id, buf, 10));
+    Exit(0);
+  }
+  //VECTORED I/O
+  else if (strcmp(argv[1], "11") == 0) {
+    TracePrintf(1, "Testing vectored pipe I/O\n");
+    int pipe_id;
+    char head[8], body[16];
+    io_vec_t out[3] = {{"len=", 4}, {"", 0}, {"hello world", 11}};
+    io_vec_t in[2] = {{head, 4}, {body, 15}};
+    PipeInit(&pipe_id);
+    int pid = Fork();
+    if (pid == 0) {
+      for (int i = 0; i < 3; i++) PipeWriteV(pipe_id, out, 3); // never interleaved with the parent's
+      Exit(0);
+    }
+    for (int i = 0; i < 3; i++) PipeWriteV(pipe_id, out, 3);
+    for (int i = 0; i < 6; i++) {
+      int got = PipeReadV(pipe_id, in, 2);
+      head[4] = '\0';
+      body[got > 4 ? got - 4 : 0] = '\0';
+      TracePrintf(1, "Read %d bytes: '%s' '%s'\n", got, head, body);
+    }
+    io_vec_t line[3] = {{"vectored ", 9}, {"tty ", 4}, {"write\n", 6}};
+    TracePrintf(1, "TtyWriteV should write 19: %d\n", TtyWriteV(0, line, 3));
+    Wait(NULL);
+    Exit(0);
+  }
+  //SHARED MEMORY
+  else if (strcmp(argv[1], "12") == 0) {
+    TracePrintf(1, "Testing shared memory and futex locks\n");
+    int shm_id = ShmCreate(2 * sizeof(int) + sizeof(ulock_t));
+    int *counter = ShmAttach(shm_id, NULL);
+    TracePrintf(1, "Attached segment %d at 0x%x\n", shm_id, counter);
+    ulock_t *lock = (ulock_t *) (counter + 2);
+    ulock_init(lock);
+    for (int i = 0; i < 4; i++) {
+      if (Fork() == 0) { // children share it
+	for (int j = 0; j < 1000; j++) {
+	  ulock_acquire(lock);
+	  int c = *counter;
+	  if (j % 100 == 0) Pause(); // let the others run into the held lock
+	  *counter = c + 1;
+	  ulock_release(lock);
+	}
+	Exit(0);
+      }
+    }
+    for (int i = 0; i < 4; i++) Wait(NULL);
+    TracePrintf(1, "Counter should be 4000: %d\n", *counter);
+    Reclaim(shm_id); // our attachment keeps the frames
+    TracePrintf(1, "Still readable after Reclaim: %d\n", *counter);
+    TracePrintf(1, "Detach should be 0: %d\n", ShmDetach(counter));
+    Exit(0);
+  }
+  //TIMED WAITS
+  else if (strcmp(argv[1], "13") == 0) {
+    TracePrintf(1, "Testing timed lock and cvar waits\n");
+    int lock_id, cvar_id;
+    LockInit(&lock_id);
+    CvarInit(&cvar_id);
+    Acquire(lock_id);
+    TracePrintf(1, "Unsignaled CvarTimedWait should be TIMEDOUT (%d): %d\n", TIMEDOUT, CvarTimedWait(cvar_id, lock_id, 3));
+    int pid = Fork();
+    if (pid == 0) {
+      TracePrintf(1, "Held lock should time out (%d): %d\n", TIMEDOUT, AcquireTimeout(lock_id, 2));
+      Acquire(lock_id);
+      CvarSignal(cvar_id);
+      Release(lock_id);
+      Exit(0);
+    }
+    Delay(4);
+    TracePrintf(1, "Signaled CvarTimedWait should be 0: %d\n", CvarTimedWait(cvar_id, lock_id, 100));
+    Release(lock_id);
+    Wait(NULL);
+    TracePrintf(1, "Free lock with 0 ticks should be 0: %d\n", AcquireTimeout(lock_id, 0));
+    Release(lock_id);
+    Exit(0);
+  }
+  //RWLOCKS
+  else if (strcmp(argv[1], "14") == 0) {
+    TracePrintf(1, "Testing reader-writer locks\n");
+    int rw_id;
+    RWLockInit(&rw_id);
+    WriteAcquire(rw_id);
+    for (int i = 0; i < 3; i++) {
+      if (Fork() == 0) { // readers queue behind the writer
+	ReadAcquire(rw_id);
+	TracePrintf(1, "Reader %d in\n", GetPid());
+	Delay(2); // all three should be in together
+	TracePrintf(1, "Reader %d out\n", GetPid());
+	RWRelease(rw_id);
+	Exit(0);
+      }
+    }
+    Delay(3);
+    TracePrintf(1, "Writer out, readers in\n");
+    RWRelease(rw_id);
+    Pause();
+    WriteAcquire(rw_id); // waits for the batch to finish
+    TracePrintf(1, "Writer back in after the readers\n");
+    TracePrintf(1, "Reclaim while held should be ERROR: %d\n", Reclaim(rw_id));
+    RWRelease(rw_id);
+    TracePrintf(1, "RWRelease without a hold should be ERROR: %d\n", RWRelease(rw_id));
+    for (int i = 0; i < 3; i++) Wait(NULL);
+    TracePrintf(1, "Reclaim should be 0: %d\n", Reclaim(rw_id));
+    Exit(0);
+  }
+  //SEMAPHORES AND BARRIERS
+  else if (strcmp(argv[1], "15") == 0) {
+    TracePrintf(1, "Testing semaphores and barriers\n");
+    int sem_id, barrier_id;
+    SemInit(&sem_id, 2);
+    BarrierInit(&barrier_id, 4);
+    for (int i = 0; i < 3; i++) {
+      if (Fork() == 0) {
+	for (int round = 0; round < 3; round++) {
+	  SemDown(sem_id); // at most 2 in here at once
+	  TracePrintf(1, "Process %d holds a unit in round %d\n", GetPid(), round);
+	  Delay(1);
+	  SemUp(sem_id);
+	  BarrierWait(barrier_id);
+	}
+	Exit(0);
+      }
+    }
+    for (int round = 0; round < 3; round++) {
+      BarrierWait(barrier_id);
+      TracePrintf(1, "Round %d done by all 4\n", round);
+    }
+    for (int i = 0; i < 3; i++) Wait(NULL);
+    TracePrintf(1, "Reclaims should be 0: %d %d\n", Reclaim(sem_id), Reclaim(barrier_id));
+    Exit(0);
+  }
+  //PIPES AND SHARED MEMORY
+  else if (strcmp(argv[1], "16") == 0) {
+    TracePrintf(1, "Testing page-sized pipe I/O from and into shared memory\n");
+    int pipe_id, src_id = ShmCreate(PAGESIZE), dst_id = ShmCreate(PAGESIZE);
+    char *src = ShmAttach(src_id, NULL), *dst = ShmAttach(dst_id, NULL); // page-aligned, so flippable
+    PipeInitCap(&pipe_id, PAGESIZE); // the copied page fits without a reader
+    for (int i = 0; i < PAGESIZE; i++) src[i] = 'a' + i % 26;
+    int pid = Fork();
+    if (pid == 0) { // the writer: its attachment must stay live after the write
+      TracePrintf(1, "Writing a page should write %d: %d\n", PAGESIZE, PipeWrite(pipe_id, src, PAGESIZE));
+      src[0] = '!'; // must not change what's queued, and must reach the parent's mapping
+      Exit(0);
+    }
+    Wait(NULL);
+    TracePrintf(1, "Writer's store should show through the segment ('!'): '%c'\n", src[0]);
+    TracePrintf(1, "Reading a page should read %d: %d\n", PAGESIZE, PipeRead(pipe_id, dst, PAGESIZE));
+    TracePrintf(1, "Queued bytes should be unchanged ('a'): '%c', ('z'): '%c'\n", dst[0], dst[25]);
+    if (Fork() == 0) { // another attacher sees the data that was read in
+      TracePrintf(1, "Child should see it through the segment too ('a'): '%c'\n", dst[0]);
+      Exit(0);
+    }
+    Wait(NULL);
+    ShmDetach(src);
+    ShmDetach(dst);
+    Reclaim(src_id);
+    Reclaim(dst_id);
+    Exit(0);
+  }
   //DEFAULT
   else {
     while(1) {
@@ -1,6 +1,6 @@
 // #include<ctype.h>
 // #include<errno.h>
-#include <yuser.h>
+#include "yuserx.h"
 
 #define MAX_LENGTH 1024  /* Should be long enough to hold any line */
 
@@ -22,10 +22,10 @@ main(int argc, char *argv[])
     Exit(-2);
   }
   termno = atoi(argv[1]);
-  /* In a real OS NUM_TERMINALS could be obtained from a lib call
-   * or a syscall
+  /* Past the hardware terminals come pseudo-terminals (see PtyOpen),
+   * so leave the upper bound to the kernel
    */
-  if (termno < 0 || termno > 3) {  
+  if (termno < 0) {  
     Exit(-3);
   }
 
@@ -50,26 +50,17 @@ main(int argc, char *argv[])
       }
       while(cmd_argv[j++] = strtok(NULL, separators))
 	;
-      if(pid = Fork())
+      if((pid = Spawn(cmd_argv[0], cmd_argv)) == -1)
 	{
-	  if(pid == -1)
-	    {
-	      TracePrintf(0,"Shell: Cannot fork process\n");
-	      continue;
-	    }
-	  if ((pid = Wait(&res)) != -1) {
-	    TtyPrintf(termno, "PID %d exit status = %d\n", pid, res);
-	  }
-	  else {
-	    TtyPrintf(termno, "PID %d aborted by kernel.\n", pid);
-	  }
-	}
-      else
-	{
-	  Exec(cmd_argv[0], cmd_argv);
 	  TtyPrintf(termno, "Could not exec `%s'.\n", buf);
-	  Exit(-2);
+	  continue;
 	}
+      if ((pid = Wait(&res)) != -1) {
+	TtyPrintf(termno, "PID %d exit status = %d\n", pid, res);
+      }
+      else {
+	TtyPrintf(termno, "PID %d aborted by kernel.\n", pid);
+      }
     }
 }
 
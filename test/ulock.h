@@ -0,0 +1,49 @@
+/* Erich Woo & Boxian Wang
+ * 10 December 2020
+ * User-space locks on top of FutexWait/FutexWake
+ *
+ * Acquire and release are a single atomic instruction when uncontended;
+ * they only trap into the kernel to sleep or to wake a sleeper. The lock
+ * word must sit in memory shared by every process using the lock
+ */
+
+#ifndef __ULOCK_H
+#define __ULOCK_H
+
+#include "yuserx.h"
+
+#define ULOCK_FREE 0
+#define ULOCK_HELD 1      // held, nobody sleeping on it
+#define ULOCK_CONTENDED 2 // held, and someone may be sleeping on it
+
+typedef struct ulock {
+  volatile int word;
+} ulock_t;
+
+static inline void ulock_init(ulock_t *l) {
+  l->word = ULOCK_FREE;
+}
+
+static inline void ulock_acquire(ulock_t *l) {
+  int c = __sync_val_compare_and_swap(&l->word, ULOCK_FREE, ULOCK_HELD);
+  if (c == ULOCK_FREE) return; // fast path
+  if (c != ULOCK_CONTENDED) c = __sync_lock_test_and_set(&l->word, ULOCK_CONTENDED);
+  while (c != ULOCK_FREE) { // we mark it contended whenever we take it from here on
+    FutexWait((int *) &l->word, ULOCK_CONTENDED);
+    c = __sync_lock_test_and_set(&l->word, ULOCK_CONTENDED);
+  }
+}
+
+/* @return 1 if we got it, 0 if it's held */
+static inline int ulock_try(ulock_t *l) {
+  return __sync_bool_compare_and_swap(&l->word, ULOCK_FREE, ULOCK_HELD);
+}
+
+static inline void ulock_release(ulock_t *l) {
+  if (__sync_fetch_and_sub(&l->word, 1) != ULOCK_HELD) { // was contended
+    l->word = ULOCK_FREE;
+    FutexWake((int *) &l->word, 1);
+  }
+}
+
+#endif // __ULOCK_H
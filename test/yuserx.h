@@ -0,0 +1,253 @@
+/* Erich Woo & Boxian Wang
+ * 2 December 2020
+ * User-side wrappers for our custom syscalls, on top of yuser.h
+ *
+ * Each wrapper traps through Custom0 with its YC_* code from ycustom.h
+ */
+
+#ifndef __YUSERX_H
+#define __YUSERX_H
+
+#include <yuser.h>
+#include "../ksrc/ycustom.h"
+
+/////////////// Processes
+
+/* Creates a child running filename with args argvec, like Fork() then Exec()
+ * but without copying our address space
+ * @return the child's pid, ERROR otherwise
+ */
+static inline int Spawn(char *filename, char **argvec) {
+  return Custom0(YC_SPAWN, (int) filename, (int) argvec, 0);
+}
+
+/* Collects the exit status of child pid, or of any child if WAIT_ANY
+ * @param flags 0 or WAIT_NOHANG to return 0 instead of blocking
+ * @return the collected child's pid, 0 if WAIT_NOHANG and not exited, ERROR otherwise
+ */
+static inline int WaitPid(int pid, int *status_ptr, int flags) {
+  return Custom0(YC_WAITPID, pid, (int) status_ptr, flags);
+}
+
+/////////////// Pipes
+
+/* Creates a pipe that may buffer up to cap (<= PIPE_MAX_CAPACITY) bytes
+ * @return 0 on success, ERROR otherwise
+ */
+static inline int PipeInitCap(int *pipe_idp, int cap) {
+  return Custom0(YC_PIPE_INIT_CAP, (int) pipe_idp, cap, 0);
+}
+
+/* Changes how many bytes the given pipe may buffer
+ * @return 0 on success, ERROR otherwise
+ */
+static inline int PipeSetCap(int pipe_id, int cap) {
+  return Custom0(YC_PIPE_SET_CAP, pipe_id, cap, 0);
+}
+
+/* Blocks until any of the n pipes/terminals in fds is ready for its events
+ * (POLL_IN/POLL_OUT), or timeout clock-ticks pass (POLL_FOREVER for no timeout)
+ * @return the # of ready entries (see their revents), 0 on timeout, ERROR otherwise
+ */
+static inline int Poll(poll_entry_t *fds, int n, int timeout) {
+  return Custom0(YC_POLL, (int) fds, n, timeout);
+}
+
+/////////////// Nonblocking I/O
+// like PipeRead/PipeWrite/TtyRead/TtyWrite, but return WOULD_BLOCK instead of
+// blocking; writes return a short count if only some of buf fits
+
+static inline int PipeReadNB(int pipe_id, void *buf, int len) {
+  return Custom0(YC_OP(YC_PIPE_READ, IO_NONBLOCK), pipe_id, (int) buf, len);
+}
+
+static inline int PipeWriteNB(int pipe_id, void *buf, int len) {
+  return Custom0(YC_OP(YC_PIPE_WRITE, IO_NONBLOCK), pipe_id, (int) buf, len);
+}
+
+static inline int TtyReadNB(int tty_id, void *buf, int len) {
+  return Custom0(YC_OP(YC_TTY_READ, IO_NONBLOCK), tty_id, (int) buf, len);
+}
+
+static inline int TtyWriteNB(int tty_id, void *buf, int len) {
+  return Custom0(YC_OP(YC_TTY_WRITE, IO_NONBLOCK), tty_id, (int) buf, len);
+}
+
+/////////////// Vectored I/O
+// scatter/gather versions of PipeRead/PipeWrite/TtyWrite over up to IOV_MAX segments;
+// a PipeWriteV that fits in the pipe, and any TtyWriteV, is never interleaved with other writers
+
+static inline int PipeReadV(int pipe_id, io_vec_t *iov, int n) {
+  return Custom0(YC_PIPE_READV, pipe_id, (int) iov, n);
+}
+
+static inline int PipeWriteV(int pipe_id, io_vec_t *iov, int n) {
+  return Custom0(YC_PIPE_WRITEV, pipe_id, (int) iov, n);
+}
+
+static inline int TtyWriteV(int tty_id, io_vec_t *iov, int n) {
+  return Custom0(YC_TTY_WRITEV, tty_id, (int) iov, n);
+}
+
+/////////////// Pseudo-terminals
+// a pty's slave side is a terminal: TtyRead/TtyWrite to its id, e.g. from a test/shell given it.
+// Its master side drives it: PtyWrite types lines into it, PtyRead gets what it wrote
+
+static inline int PtyOpen(int *pty_idp) {
+  return Custom0(YC_PTY_OPEN, (int) pty_idp, 0, 0);
+}
+
+static inline int PtyClose(int pty_id) {
+  return Custom0(YC_PTY_CLOSE, pty_id, 0, 0);
+}
+
+/* Blocks until the slave side wrote something
+ * @return # of bytes read, ERROR
+ */
+static inline int PtyRead(int pty_id, void *buf, int len) {
+  return Custom0(YC_PTY_READ, pty_id, (int) buf, len);
+}
+
+/* Never blocks: input that doesn't fit in the slave's input ring isn't taken
+ * @return # of bytes taken, ERROR
+ */
+static inline int PtyWrite(int pty_id, void *buf, int len) {
+  return Custom0(YC_PTY_WRITE, pty_id, (int) buf, len);
+}
+
+/////////////// Locks
+
+/* Switches the lock between LOCK_MESA (default) and LOCK_HANDOFF,
+ * where Release passes it straight to the longest waiter
+ * @return 0 on success, ERROR otherwise
+ */
+static inline int LockSetMode(int lock_id, int mode) {
+  return Custom0(YC_LOCK_SET_MODE, lock_id, mode, 0);
+}
+
+/* Acquire(), giving up after ticks clock-ticks (0 only tries once)
+ * @return 0, TIMEDOUT, ERROR */
+static inline int AcquireTimeout(int lock_id, int ticks) {
+  return Custom0(YC_ACQUIRE_TIMEOUT, lock_id, ticks, 0);
+}
+
+/* CvarWait(), giving up on a signal after ticks clock-ticks; the lock is held again either way
+ * @return 0 if signaled, TIMEDOUT, ERROR */
+static inline int CvarTimedWait(int cvar_id, int lock_id, int ticks) {
+  return Custom0(YC_CVAR_TIMED_WAIT, cvar_id, lock_id, ticks);
+}
+
+/////////////// Reader-writer locks
+// any number of readers or one writer; a waiting writer holds off new readers,
+// and a writer's release lets in all the readers that queued behind it together.
+// Holds don't nest: ReadAcquire/WriteAcquire on one we already hold is an ERROR
+
+/* @return 0 on success, ERROR otherwise */
+static inline int RWLockInit(int *rwlock_idp) {
+  return Custom0(YC_RWLOCK_INIT, (int) rwlock_idp, 0, 0);
+}
+
+static inline int ReadAcquire(int rwlock_id) {
+  return Custom0(YC_READ_ACQUIRE, rwlock_id, 0, 0);
+}
+
+static inline int WriteAcquire(int rwlock_id) {
+  return Custom0(YC_WRITE_ACQUIRE, rwlock_id, 0, 0);
+}
+
+/* Releases whichever hold we have, read or write */
+static inline int RWRelease(int rwlock_id) {
+  return Custom0(YC_RW_RELEASE, rwlock_id, 0, 0);
+}
+
+/////////////// Barriers
+// SemInit/SemUp/SemDown are Yalnix's own syscalls; barriers go through Custom0
+
+/* A barrier that lets processes through n at a time
+ * @return 0 on success, ERROR otherwise */
+static inline int BarrierInit(int *barrier_idp, int n) {
+  return Custom0(YC_BARRIER_INIT, (int) barrier_idp, n, 0);
+}
+
+/* Blocks until n processes are waiting, then they all go on
+ * @return 0 on success, ERROR otherwise */
+static inline int BarrierWait(int barrier_id) {
+  return Custom0(YC_BARRIER_WAIT, barrier_id, 0, 0);
+}
+
+/////////////// Shared memory
+// segments of frames mapped into every attached process; Reclaim(shm_id) removes one,
+// its frames go once every process has detached (or exec'd/exited)
+
+/* @return the new segment's id, ERROR */
+static inline int ShmCreate(int size) {
+  return Custom0(YC_SHM_CREATE, size, 0, 0);
+}
+
+/* Maps the segment at page-aligned addr, or wherever the kernel picks if NULL.
+ * Fork()-ed children inherit it
+ * @return where it's mapped, (void *) ERROR
+ */
+static inline void *ShmAttach(int shm_id, void *addr) {
+  return (void *) Custom0(YC_SHM_ATTACH, shm_id, (int) addr, 0);
+}
+
+static inline int ShmDetach(void *addr) {
+  return Custom0(YC_SHM_DETACH, (int) addr, 0, 0);
+}
+
+/////////////// Futexes
+// the kernel half of user-space locks (see ulock.h): sleep only when the word says there's contention
+
+/* Sleeps until FutexWake on addr, unless *addr != val by then
+ * @return 0 once woken, FUTEX_CHANGED if *addr != val, ERROR
+ */
+static inline int FutexWait(int *addr, int val) {
+  return Custom0(YC_FUTEX_WAIT, (int) addr, val, 0);
+}
+
+/* Wakes up to n processes sleeping on addr
+ * @return the # woken, ERROR
+ */
+static inline int FutexWake(int *addr, int n) {
+  return Custom0(YC_FUTEX_WAKE, (int) addr, n, 0);
+}
+
+/////////////// Timing
+
+/* @return the # of clock-ticks since boot */
+static inline int GetTicks(void) {
+  return Custom0(YC_GET_TICKS, 0, 0, 0);
+}
+
+/////////////// Statistics
+
+/* Copies the statistics of pipe/lock/cvar/rwlock/sem/barrier id into *stat
+ * @return 0 on success, ERROR otherwise
+ */
+static inline int IpcStat(int id, ipc_stat_t *stat) {
+  return Custom0(YC_IPC_STAT, id, (int) stat, 0);
+}
+
+/* Copies the statistics of all pipes/locks/cvars/rwlocks/sems/barriers into stats, up to max
+ * @return the total # of them alive, ERROR otherwise
+ */
+static inline int IpcList(ipc_stat_t *stats, int max) {
+  return Custom0(YC_IPC_LIST, (int) stats, max, 0);
+}
+
+/* Summarizes physical frame usage by pid and purpose into *info
+ * @return 0 on success, ERROR otherwise
+ */
+static inline int MemInfo(mem_info_t *info) {
+  return Custom0(YC_MEM_INFO, (int) info, 0, 0);
+}
+
+/* Copies the kernel heap size/headroom and per-site usage into *info
+ * @return 0 on success, ERROR otherwise
+ */
+static inline int KHeapInfo(kheap_info_t *info) {
+  return Custom0(YC_KHEAP_INFO, (int) info, 0, 0);
+}
+
+#endif // __YUSERX_H